@@ -0,0 +1,65 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CoroutineFrameAllocator.h"
+
+#include <new>
+
+thread_local MemoryPool* CoroutineFrameAllocator::t_threadPool = nullptr;
+
+// Method selects pool for calling thread
+MemoryPool*
+CoroutineFrameAllocator::SetThreadPool( MemoryPool* pool )
+{
+	MemoryPool* previousPool = t_threadPool;
+	t_threadPool = pool;
+	return previousPool;
+}
+///////////////////////////////////////////////////////////
+
+// Method returns pool selected by calling thread
+MemoryPool*
+CoroutineFrameAllocator::GetThreadPool(void)
+{
+	return t_threadPool;
+}
+///////////////////////////////////////////////////////////
+
+// Method allocates frame with pool stored in front of it, frame comes from
+// global operator new if pool is exhausted so nullptr is never returned
+void*
+CoroutineFrameAllocator::AllocateFrame( size_t size )
+{
+	MemoryPool* pool = t_threadPool;
+
+	void* header = (pool != nullptr) ? pool->TryAllocate( size + FRAME_HEADER_SIZE ) : nullptr;
+	if(header == nullptr)
+	{
+		pool = nullptr;
+		header = ::operator new( size + FRAME_HEADER_SIZE );
+	}
+	*reinterpret_cast<MemoryPool**>(header) = pool;
+
+	return reinterpret_cast<char*>(header) + FRAME_HEADER_SIZE;
+}
+///////////////////////////////////////////////////////////
+
+// Method returns frame into pool it was allocated from
+void
+CoroutineFrameAllocator::DeallocateFrame( void* frame, size_t size )
+{
+	void* header = reinterpret_cast<char*>(frame) - FRAME_HEADER_SIZE;
+	MemoryPool* pool = *reinterpret_cast<MemoryPool**>(header);
+
+	if(pool != nullptr)
+	{
+		pool->Deallocate( header, size + FRAME_HEADER_SIZE );
+	}
+	else
+	{
+		::operator delete( header );
+	}
+}
+///////////////////////////////////////////////////////////
@@ -0,0 +1,86 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MemoryPool.h"
+
+
+//	Class:		CoroutineFrameAllocator
+//	Author:		Rafal Rebisz
+//	Purpose:	Routes coroutine frame allocations to memory pool
+//				selected by the thread that creates the coroutine
+
+//	Use:		Derive coroutine promise type from PooledCoroutinePromise,
+//				each thread (or scheduler running on it) selects pool with
+//				SetThreadPool or ScopedPool. Frames of coroutines created
+//				while no pool is selected or when selected pool is exhausted
+//				come from global operator new, which throws std::bad_alloc.
+//				Pool is asked with TryAllocate, pool that does not override it
+//				asserts when exhausted instead of falling back
+
+//	NOTE:		Every frame is prefixed with FRAME_HEADER_SIZE bytes holding
+//				the pool it came from, so frame is returned to its own pool
+//				whatever thread destroys it. Frame size is known when frame is
+//				destroyed so pool receives sized Deallocate, SizeClassPool serves
+//				common frame sizes from fixed size pools in O(1). Pool is used
+//				from every thread that creates or destroys frames in it, if frames
+//				are destroyed by other threads wrap pool in OwnedMemoryPool
+
+class CoroutineFrameAllocator
+{
+public: // Constants
+
+	// bytes in front of every frame, keeps frames 16 byte aligned
+	static const size_t FRAME_HEADER_SIZE = 16;
+
+public: // Structures
+
+	// Selects pool for calling thread until end of scope
+	class ScopedPool
+	{
+	public:
+		explicit ScopedPool( MemoryPool* pool ): m_previousPool( SetThreadPool( pool ) ) {}
+		~ScopedPool(void) { SetThreadPool( m_previousPool ); }
+
+		ScopedPool( const ScopedPool& ) = delete;
+		ScopedPool& operator=( const ScopedPool& ) = delete;
+
+	private:
+		MemoryPool* m_previousPool;
+	};
+
+public: // Methods
+
+	// Sets pool frames of calling thread are allocated from,
+	// returns previously selected pool
+	static MemoryPool* SetThreadPool( MemoryPool* pool );
+
+	// Returns pool selected by calling thread, nullptr if none
+	static MemoryPool* GetThreadPool(void);
+
+	// Allocates coroutine frame of given size
+	static void* AllocateFrame( size_t size );
+
+	// Returns coroutine frame, size must be the size frame was allocated with
+	static void DeallocateFrame( void* frame, size_t size );
+
+private: // Members
+
+	// pool selected by each thread
+	static thread_local MemoryPool* t_threadPool;
+};
+
+
+//	Class:		PooledCoroutinePromise
+//	Author:		Rafal Rebisz
+//	Purpose:	Promise type mixin, coroutines with promise type derived
+//				from it allocate their frames with CoroutineFrameAllocator
+
+struct PooledCoroutinePromise
+{
+	static void* operator new( size_t size ) { return CoroutineFrameAllocator::AllocateFrame( size ); }
+	static void operator delete( void* frame, size_t size ) { CoroutineFrameAllocator::DeallocateFrame( frame, size ); }
+};
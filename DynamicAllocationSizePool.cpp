@@ -5,18 +5,53 @@
 
 #include "DynamicAllocationSizePool.h"
 
+#include <cstdint>
+#include <cstring>
+
 // Constructor
-DynamicAllocationSizePool::DynamicAllocationSizePool( void* memory, size_t poolSize, std::string poolID ):
+DynamicAllocationSizePool::DynamicAllocationSizePool( void* memory, size_t poolSize, std::string poolID, bool deferCoalescing, bool memoryIsZeroed ):
 	MemoryPool(memory,poolSize,poolID,"DynamicAllocationSizePool"),
 	m_totalOverhead(0),
-	m_OVERHEAD(sizeof(AllocationBlock))
+	m_OVERHEAD(sizeof(AllocationBlock)),
+	m_runMap(nullptr),
+	m_runMapBase(nullptr),
+	m_deferCoalescing(deferCoalescing),
+	m_nrOfQuickBlocks(0),
+	m_zeroWatermark(reinterpret_cast<char*>(memory) + poolSize),
+	m_handles(nullptr),
+	m_nrOfHandles(0),
+	m_freeHandle(0),
+	m_compactCursor(nullptr),
+	m_verifyCursor(nullptr)
 {
+#ifdef POOL_HARDENED
+	// key is needed by the first block header
+	m_hardeningKey = CreateHardeningKey( this );
+#endif
+
 	// Pool size must be at least 28 bytes
 	assert( poolSize > (sizeof( AllocationBlock ) + sizeof(int)) && " Pool Size to small" );
 
 	// Create the main memory block 
 	m_mainBlock = CreateBlock( reinterpret_cast<char*>(memory), poolSize - m_OVERHEAD );
 	m_totalOverhead += m_OVERHEAD;
+
+	// only main block header was written
+	if(memoryIsZeroed)
+	{
+		m_zeroWatermark = reinterpret_cast<char*>(m_mainBlock + 1);
+	}
+
+	// no runs exist until first small allocation
+	for(size_t i = 0; i < NR_OF_SMALL_CLASSES; i++)
+	{
+		m_smallRuns[i] = nullptr;
+	}
+
+	for(size_t i = 0; i < NR_OF_QUICK_LISTS; i++)
+	{
+		m_quickLists[i] = nullptr;
+	}
 }
 ///////////////////////////////////////////////////////////
 
@@ -30,76 +65,138 @@ DynamicAllocationSizePool::~DynamicAllocationSizePool(void)
 void* 
 DynamicAllocationSizePool::Allocate( size_t requestedSize)
 {
-	// Temporary variables
-	AllocationBlock* blockToUse = nullptr;
+	void* address = DynamicAllocationSizePool::TryAllocate( requestedSize );
 
-	// Check if any blocks can be recycled
-	blockToUse = FindBlockOfBestSize(requestedSize);
+	// If nullptr than ether no free memory available or available memory
+	// is not big enough to allocate from 
+	assert( address != nullptr && "No Free Memory Or Pool has become fragmented" );
+	return address;
+}
+///////////////////////////////////////////////////////////
 
-	// if block can be recycled
+// Method allocates memory block of requested size, unlike Allocate
+// it does not treat running out of memory as an error
+void*
+DynamicAllocationSizePool::TryAllocate( size_t requestedSize )
+{
+	// small requests are served from runs, if no run can
+	// be created request is served as any other allocation
+	if(requestedSize <= SMALL_ALLOCATION_LIMIT)
+	{
+		void* slot = AllocateSlot( requestedSize );
+		if(slot != nullptr)
+		{
+			return slot;
+		}
+	}
+
+	AllocationBlock* blockToUse = AllocateBlock( requestedSize );
 	if(blockToUse != nullptr)
 	{
-		return RecycleBlock( blockToUse, requestedSize);
+		// block may be bigger than requested, its whole size
+		// is counted so Deallocate subtracts the same amount
+		m_totalAllocated += blockToUse->allocSize;
+		m_nrOfAllocations++;
+
+		return (++blockToUse);
 	}
 
-	// if here than ether no recyclable blocks are available or
-	// they are to small. Allocate from main block if a available
-	else if(blockToUse == nullptr && m_mainBlock != nullptr)
-	{ 
-		// check if space will be left after allocation, must be 
-		// enough to allocate at least 4bytes after creating new block
+	return nullptr;
+}
+///////////////////////////////////////////////////////////
 
-		if(((int)(m_mainBlock->allocSize - requestedSize)) >= ((int)(m_OVERHEAD + 4)))
-		{
-			// Calculate new size and address for mainBlock, it will be created
-			// at the address of (mainBlock + allocationSize) 
-			char* address = (reinterpret_cast<char*>(m_mainBlock) + m_OVERHEAD + requestedSize);
-			size_t newBlockSize = (m_mainBlock->allocSize - m_OVERHEAD - requestedSize);
+// Method allocates zero filled memory
+void*
+DynamicAllocationSizePool::AllocateZeroed( size_t requestedSize )
+{
+	void* address = TryAllocateZeroed( requestedSize );
+
+	assert( address != nullptr && "No Free Memory Or Pool has become fragmented" );
+	return address;
+}
+///////////////////////////////////////////////////////////
 
-			// copy existing mainBlock address to the pointer of
-			// block that will be used and update its values 
-			blockToUse = m_mainBlock;
-			blockToUse->allocSize = requestedSize;
-			blockToUse->isAllocated = true;
+// Method allocates memory and clears part of it below zero watermark,
+// allocation only writes headers outside of returned memory so bytes
+// above watermark taken before allocation are still zero
+void*
+DynamicAllocationSizePool::TryAllocateZeroed( size_t requestedSize )
+{
+	char* zeroFrom = m_zeroWatermark;
+	char* address = reinterpret_cast<char*>(DynamicAllocationSizePool::TryAllocate( requestedSize ));
 
-			// Create new mainBlock at previously calculated address 
-			m_mainBlock = CreateBlock( address, newBlockSize );
+	if(address != nullptr)
+	{
+		ClearUsedBytes( address, requestedSize, zeroFrom );
+	}
 
-			// update physical links
-			m_mainBlock->PhysicalPrevious = blockToUse;
-			blockToUse->PhysicalNext = m_mainBlock;
+	return address;
+}
+///////////////////////////////////////////////////////////
 
-			// Update values in pool data members
-			m_totalOverhead += m_OVERHEAD;
-			m_nrOfBlocks++;
-			m_totalAllocated += requestedSize;
-			m_nrOfAllocations++;
+// Method allocates block with room for aligned memory, space in front of aligned
+// memory becomes free block of its own so returned address has block header
+// directly in front of it and is returned into pool as any other block
+void*
+DynamicAllocationSizePool::TryAllocateAligned( size_t requestedSize, size_t alignment )
+{
+	assert( alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be power of two" );
 
-			return (++blockToUse);
-		}
-		// if mainBlock is big enough to allocate from it
-		// but not big enough to split it, than it will be used 
-		// "as it is" the mainBlock pointer will be set to nullptr
-		// indicating that there is no free space in main memory 
-		// however there still may be space available in recyclableBlocks list
-		else if(m_mainBlock->allocSize >= requestedSize)
-		{
-			blockToUse = m_mainBlock;
-			blockToUse->isAllocated = true;
+	// leading free block needs room for its header and at least 4 bytes,
+	// request is rejected before rounding so none of the sums can wrap
+	size_t leadingSpace = m_OVERHEAD + SMALL_SIZE_GRANULARITY;
+	if(requestedSize > ~(size_t)0 - leadingSpace - alignment - (SMALL_SIZE_GRANULARITY - 1))
+	{
+		return nullptr;
+	}
 
-			m_totalAllocated += requestedSize;
-			m_nrOfAllocations++;
+	// size is kept multiple of granularity so header behind it stays aligned
+	requestedSize = ((requestedSize + SMALL_SIZE_GRANULARITY - 1) / SMALL_SIZE_GRANULARITY) * SMALL_SIZE_GRANULARITY;
+	if(requestedSize == 0)
+	{
+		requestedSize = SMALL_SIZE_GRANULARITY;
+	}
+
+	AllocationBlock* block = AllocateBlock( requestedSize + leadingSpace + alignment );
+	if(block == nullptr)
+	{
+		return nullptr;
+	}
+
+	uintptr_t address = reinterpret_cast<uintptr_t>(block + 1);
+	if((address % alignment) != 0)
+	{
+		uintptr_t alignedAddress = (address + leadingSpace + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t gap = (size_t)(alignedAddress - address);
 
-			m_mainBlock = nullptr;
+		// header of aligned block is placed directly in front of aligned address
+		AllocationBlock* alignedBlock = CreateBlock( reinterpret_cast<char*>(alignedAddress) - m_OVERHEAD, block->allocSize - gap );
+		alignedBlock->isAllocated = true;
 
-			return (++blockToUse);
+		alignedBlock->PhysicalPrevious = block;
+		alignedBlock->PhysicalNext = block->PhysicalNext;
+		if(alignedBlock->PhysicalNext != nullptr)
+		{
+			alignedBlock->PhysicalNext->PhysicalPrevious = alignedBlock;
 		}
+
+		block->PhysicalNext = alignedBlock;
+		block->allocSize = gap - m_OVERHEAD;
+
+		m_totalOverhead += m_OVERHEAD;
+		m_nrOfBlocks++;
+
+		// leading block merges with free block in front of it or is recycled
+		DeallocateBlock( block );
+		block = alignedBlock;
 	}
 
-	// If here than ether no free memory available or available memory
-	// is not big enough to allocate from 
-	assert( false && "No Free Memory Or Pool has become fragmented" );
-	return nullptr;
+	TrimBlock( block, requestedSize );
+
+	m_totalAllocated += block->allocSize;
+	m_nrOfAllocations++;
+
+	return (++block);
 }
 ///////////////////////////////////////////////////////////
 
@@ -110,383 +207,1433 @@ void DynamicAllocationSizePool::Deallocate( void* address )
 	// when in debug mode check if returned address belongs to given pool
 #ifdef _DEBUG
 	assert( CheckIfAllocatedHere( address ) == true && "Memory wasn't allocated in this pool !" );
+	assert( (IsInRun( address ) || (reinterpret_cast<AllocationBlock*>(address) - 1)->isRelocatable == false) && "Relocatable memory must be returned with DeallocateRelocatable" );
 #endif
 
+	// slots of small runs do not have a block header
+	if(IsInRun( address ))
+	{
+		DeallocateSlot( address );
+		return;
+	}
+
 	// decrement value of pointer to get to the memory occupied by block instance
 	AllocationBlock* returnedBlock = reinterpret_cast<AllocationBlock*>(address);
 	returnedBlock--;
 
-	// update block flag 
-	returnedBlock->isAllocated = false;
-	// store block size in temp variable 
-	size_t sizeReturned = returnedBlock->allocSize;
+	ReturnBlock( returnedBlock );
+}
+///////////////////////////////////////////////////////////
 
-	// get preceding physical block
-	AllocationBlock* physicalPrev = returnedBlock->PhysicalPrevious;
+// Sized Deallocate, blocks bigger than small allocation limit are never
+// served from runs so run map is not read for them
+void
+DynamicAllocationSizePool::Deallocate( void* address, size_t size )
+{
+#ifdef _DEBUG
+	assert( CheckIfAllocatedHere( address ) == true && "Memory wasn't allocated in this pool !" );
+	// block can be bigger than requested when it was not worth splitting
+	// or was taken from next quick list
+	size_t allocationSize = GetAllocationSize( address );
+	assert( size <= allocationSize && allocationSize - size < m_OVERHEAD + 4 + (2 * QUICK_LIST_GRANULARITY) && "Size does not match allocation" );
+	assert( (IsInRun( address ) || (reinterpret_cast<AllocationBlock*>(address) - 1)->isRelocatable == false) && "Relocatable memory must be returned with DeallocateRelocatable" );
+#endif
 
-	// Check if preceding and returned block can be merged
-	if(physicalPrev != nullptr && physicalPrev->isAllocated == false)
+	if(size <= SMALL_ALLOCATION_LIMIT && IsInRun( address ))
 	{
-		//if preceding block exist and it is free than it must be on recycledBlocks list 
-		// Remove it from recycled list
-		m_recycledBlocks.Remove( physicalPrev );
-
+		DeallocateSlot( address );
+		return;
+	}
 
-		// NOTE: because returnedBlock is at proceeding address 
-		// the merging operation will be done from "right to left" witch means the
-		// preceding block links and values are going to be updated and
-		// current block "returnedBlock" will be "abandoned"
+	ReturnBlock( reinterpret_cast<AllocationBlock*>(address) - 1 );
+}
+///////////////////////////////////////////////////////////
 
-		// update preceding block size
-		physicalPrev->allocSize += (returnedBlock->allocSize + m_OVERHEAD);
+// Method returns size of main block or biggest recycled block,
+// blocks waiting on quick lists are not counted as free
+size_t
+DynamicAllocationSizePool::GetLargestFreeBlock(void) const
+{
+	size_t largest = (m_mainBlock != nullptr) ? m_mainBlock->allocSize : 0;
 
-		// Update preceding block physical links
-		physicalPrev->PhysicalNext = returnedBlock->PhysicalNext;
-		if(physicalPrev->PhysicalNext != nullptr)
+	for(AllocationBlock* block = m_recycledBlocks.GetFirst(); block != nullptr; block = block->LogicalNext)
+	{
+		if(block->allocSize > largest)
 		{
-			physicalPrev->PhysicalNext->PhysicalPrevious = physicalPrev;
+			largest = block->allocSize;
 		}
+	}
 
-		// after merging operation preceding block became larger 
-		// and links has been updated, store its address in returnedBlock pointer
-		returnedBlock = physicalPrev;
+	return largest;
+}
+///////////////////////////////////////////////////////////
 
-		// update pool data members 
-		// overhead and block number is decremented as 
-		// blocks has been merged
-		m_totalOverhead -= m_OVERHEAD;
-		m_nrOfBlocks--;
+// Method returns size of slot or block allocated at given address
+size_t
+DynamicAllocationSizePool::GetAllocationSize( void* address ) const
+{
+	if(IsInRun( address ))
+	{
+		return reinterpret_cast<SmallRun*>(reinterpret_cast<uintptr_t>(address) & ~(uintptr_t)(RUN_SIZE - 1))->slotSize;
 	}
 
-	// NOTE: if merging succeed returnedBlock pointer points to "new" bigger block else
-	// returnedBlock is "untouched" in ether case the check can be done to see if it
-	// can be merged with proceeding block
-
-	// Get proceeding block
-	AllocationBlock* physicalNext = returnedBlock->PhysicalNext;
+	return (reinterpret_cast<AllocationBlock*>(address) - 1)->allocSize;
+}
+///////////////////////////////////////////////////////////
 
-	// if physical next block is nullptr and the main block is also nullptr
-	// than current block "returnedBlock" must be the last physical block in pool, 
-	// therefore it will become the mainBlock and method will terminate
-	if(physicalNext == nullptr && m_mainBlock == nullptr)
+// Method returns every block waiting on quick lists into pool
+// merging it with free physical neighbours
+void
+DynamicAllocationSizePool::CoalesceQuickLists(void)
+{
+	for(size_t i = 0; i < NR_OF_QUICK_LISTS; i++)
 	{
-		// store current block address in mainBlock pointer
-		m_mainBlock = returnedBlock;
-		// update pool data members 
-		m_nrOfAllocations--;
-		m_totalAllocated -= sizeReturned;
+		AllocationBlock* block = m_quickLists[i];
+		m_quickLists[i] = nullptr;
 
-		return;
-	}
-	else if(physicalNext == m_mainBlock)
-	{
-		// if here than next physical block is the m_mainBlock 
-		// witch means current block "returnedBlock" can be merged with it
-		// because the main block is at proceeding address the merging
-		// operation will be done from "right to left" therefore returned 
-		// block is going to become the mainBlock its links and values are going
-		// to be updated and method will terminate
+		while(block != nullptr)
+		{
+			AllocationBlock* next = block->LogicalNext;
+			block->LogicalNext = nullptr;
 
-		// update current block size
-		returnedBlock->allocSize += (m_mainBlock->allocSize + m_OVERHEAD);
+#ifdef POOL_HARDENED
+			block->canary = GetCanary( block );
+#endif
 
-		// set next physical block to nullptr as this block became the last physical block in pool
-		returnedBlock->PhysicalNext = nullptr;
+			DeallocateBlock( block );
+			block = next;
+		}
+	}
 
-		// store returnedBlock address in the mainBlock pointer
-		m_mainBlock = returnedBlock;
- 
-		// update pool data members
+	m_nrOfQuickBlocks = 0;
+}
+///////////////////////////////////////////////////////////
 
-		// overhead and block number is decremented as 
-		// blocks has been merged
-		m_totalOverhead -= m_OVERHEAD;
-		m_nrOfBlocks--;
+// Method allocates relocatable memory and returns its handle
+DynamicAllocationSizePool::Handle
+DynamicAllocationSizePool::AllocateRelocatable( size_t requestedSize )
+{
+	Handle handle = TryAllocateRelocatable( requestedSize );
 
-		m_nrOfAllocations--;
-		m_totalAllocated -= sizeReturned;
+	assert( handle != INVALID_HANDLE && "No Free Memory Or Pool has become fragmented" );
+	return handle;
+}
+///////////////////////////////////////////////////////////
 
-		return;
+// Method allocates relocatable memory, relocatable memory always
+// has a block header so it is never served from small runs
+DynamicAllocationSizePool::Handle
+DynamicAllocationSizePool::TryAllocateRelocatable( size_t requestedSize )
+{
+	AllocationBlock* blockToUse = AllocateBlock( requestedSize );
+	if(blockToUse == nullptr)
+	{
+		return INVALID_HANDLE;
 	}
 
-	else if(physicalNext != nullptr && physicalNext->isAllocated == false)
+	Handle handle = TakeHandle( blockToUse );
+	if(handle == INVALID_HANDLE)
 	{
-		// if here than next physical block must be free and on recycledBlocks
-		// list witch means blocks can be merged, the merging operation
-		// will be done from "right to left" current block "returnedBlock" is at preceding address  
-		// and therefore its links and values are going to be updated, proceeding block will be "abandoned"
-		// merged block will be inserted back to the recycledBlocks list and method will terminate
-
-		// Remove proceeding block from recycled list
-		m_recycledBlocks.Remove( physicalNext );
-
-		// blocks Can be merged now
+		DeallocateBlock( blockToUse );
+		return INVALID_HANDLE;
+	}
 
-		// update current block size
-		returnedBlock->allocSize += (physicalNext->allocSize + m_OVERHEAD);
+	blockToUse->isRelocatable = true;
+	blockToUse->handleIndex = handle;
 
-		// update its physical links
-		returnedBlock->PhysicalNext = physicalNext->PhysicalNext;
-		if(returnedBlock->PhysicalNext != nullptr)
-		{
-			returnedBlock->PhysicalNext->PhysicalPrevious = returnedBlock;
-		}
+	m_totalAllocated += blockToUse->allocSize;
+	m_nrOfAllocations++;
 
-		// re-insert merged block to recycled list 
-		m_recycledBlocks.Insert( returnedBlock );
+	return handle;
+}
+///////////////////////////////////////////////////////////
 
-		// update pool data members
+// Method returns relocatable memory, block is merged with its neighbours
+// straight away so the space is not pinned on quick lists
+void
+DynamicAllocationSizePool::DeallocateRelocatable( Handle handle )
+{
+	// entry of returned handle no longer holds a block so
+	// stale handle is caught before any header is read
+	if(IsHandleLive( handle ) == false)
+	{
+#ifdef POOL_HARDENED
+		ReportCorruption( "Handle was already returned or is incorrect", m_handles );
+#else
+		assert( false && "Handle was already returned or is incorrect" );
+#endif
+		return;
+	}
 
-		// overhead and block number is decremented as 
-		// blocks has been merged
-		m_totalOverhead -= m_OVERHEAD;
-		m_nrOfBlocks--;
+	AllocationBlock* returnedBlock = m_handles[handle - 1].block;
 
-		m_nrOfAllocations--;
-		m_totalAllocated -= sizeReturned;
+#ifdef _DEBUG
+	assert( returnedBlock->isRelocatable == true && returnedBlock->handleIndex == handle && "Handle does not match block" );
+#endif
 
+#ifdef POOL_HARDENED
+	if(CheckReturnedBlock( returnedBlock ) == false)
+	{
 		return;
 	}
-	else
-	{
-		// if here than block cannot be merged ether with previous 
-		// and/or with next block just insert it to recycled list 
-		m_recycledBlocks.Insert( returnedBlock );
-		m_nrOfAllocations--;
-		m_totalAllocated -= sizeReturned;
 
+	if(returnedBlock->handleIndex != handle)
+	{
+		ReportCorruption( "Handle does not match block", returnedBlock + 1 );
 		return;
 	}
+#endif
+
+	m_handles[handle - 1].block = nullptr;
+	m_handles[handle - 1].nextFree = m_freeHandle;
+	m_freeHandle = handle;
+
+	returnedBlock->isRelocatable = false;
+	returnedBlock->handleIndex = 0;
+
+	m_nrOfAllocations--;
+	m_totalAllocated -= returnedBlock->allocSize;
+
+	DeallocateBlock( returnedBlock );
 }
 ///////////////////////////////////////////////////////////
 
+// Method returns current address of relocatable memory
+void*
+DynamicAllocationSizePool::GetAddress( Handle handle ) const
+{
+	if(IsHandleLive( handle ) == false)
+	{
+#ifdef POOL_HARDENED
+		ReportCorruption( "Handle was already returned or is incorrect", m_handles );
+#else
+		assert( false && "Handle was already returned or is incorrect" );
+#endif
+		return nullptr;
+	}
 
-/******************* Internal Methods *********************/
+	AllocationBlock* block = m_handles[handle - 1].block;
 
-// internal method used to search through recycled 
-// blocks list for block of best possible size 
-// it searches through the list from front to back and back to front at the same time
-// to minimize search time and it will return ether a block of size exactly
-// as requested (if available) or the smallest block that allocation can be done from
-// if no such block is available it will return nullptr indicating that none of available
-// blocks are big enough to allocate from, or there is no blocks that can be recycled at all
-DynamicAllocationSizePool::AllocationBlock* 
-DynamicAllocationSizePool::FindBlockOfBestSize( size_t requestedSize) const
+#ifdef _DEBUG
+	assert( block->isRelocatable == true && block->handleIndex == handle && "Handle does not match block" );
+#endif
+
+	return block + 1;
+}
+///////////////////////////////////////////////////////////
+
+// Method continues compaction pass, free block followed by relocatable block
+// swaps place with it so free space travels towards the end of pool merging
+// with free blocks on its way until it merges into main block
+bool
+DynamicAllocationSizePool::Compact( size_t maxBlocks )
 {
-	AllocationBlock* tempFront = m_recycledBlocks.GetFirst();
-	AllocationBlock* tempBack = m_recycledBlocks.GetLast();
-	AllocationBlock* bestSoFar = nullptr;
+	// new pass starts at first block, blocks waiting
+	// on quick lists would stay in the way of moved blocks
+	if(m_compactCursor == nullptr)
+	{
+		if(m_nrOfQuickBlocks != 0)
+		{
+			CoalesceQuickLists();
+		}
 
-	// While there are blocks available
-	// the "back" pointer does not need to
-	// be checked as if there are any blocks
-	// on the list both pointers cannot be nullptr
-	while(tempFront != nullptr)
+		m_compactCursor = reinterpret_cast<AllocationBlock*>(m_poolMemory);
+	}
+
+	for(size_t i = 0; i < maxBlocks && m_compactCursor != nullptr && m_compactCursor != m_mainBlock; i++)
 	{
-		// If block size is exactly as requested there 
-		// is no need to search any more return the appropriate block
-		// this is first of two ways a while loop will terminate
-		if(tempFront->allocSize == requestedSize)
+		AllocationBlock* block = m_compactCursor;
+		AllocationBlock* physicalNext = block->PhysicalNext;
+
+		if(block->isAllocated == false && physicalNext != nullptr && physicalNext->isRelocatable == true)
 		{
-			return tempFront;
+			m_compactCursor = SlideBlock( block, physicalNext );
 		}
-		else if(tempBack->allocSize == requestedSize)
+		else
 		{
-			return tempBack;
+			m_compactCursor = physicalNext;
 		}
-		///////////////////////////////////////////
+	}
 
-		// if the search meet than size will be checked and if
+	// pass ends at main block or at last block when there is no main block
+	if(m_compactCursor == nullptr || m_compactCursor == m_mainBlock)
+	{
+		m_compactCursor = nullptr;
+		return true;
+	}
+
+	return false;
+}
+///////////////////////////////////////////////////////////
+
+// Method continues verification pass, pass stops at first corrupted
+// block as links of corrupted block can not be followed
+bool
+DynamicAllocationSizePool::VerifyHeap( size_t maxBlocks )
+{
+	if(m_verifyCursor == nullptr)
+	{
+		m_verifyCursor = reinterpret_cast<AllocationBlock*>(m_poolMemory);
+
+		if(m_verifyCursor->PhysicalPrevious != nullptr)
+		{
+			m_verifyCursor = nullptr;
+			ReportCorruption( "First block has previous block", m_poolMemory );
+			return true;
+		}
+	}
+
+	for(size_t i = 0; i < maxBlocks && m_verifyCursor != nullptr; i++)
+	{
+		AllocationBlock* block = m_verifyCursor;
+
+		const char* problem = CheckBlock( block );
+		if(problem != nullptr)
+		{
+			m_verifyCursor = nullptr;
+			ReportCorruption( problem, block + 1 );
+			return true;
+		}
+
+		m_verifyCursor = block->PhysicalNext;
+	}
+
+	return m_verifyCursor == nullptr;
+}
+///////////////////////////////////////////////////////////
+
+
+/******************* Internal Methods *********************/
+
+// internal method allocates block ether by recycling one of
+// returned blocks or by splitting the main block 
+DynamicAllocationSizePool::AllocationBlock*
+DynamicAllocationSizePool::AllocateBlock( size_t requestedSize )
+{
+	// block of matching size returned in deferred mode can be used as it is
+	if(m_nrOfQuickBlocks != 0)
+	{
+		AllocationBlock* quickBlock = TakeQuickBlock( requestedSize );
+		if(quickBlock != nullptr)
+		{
+			return quickBlock;
+		}
+	}
+
+	// Check if any blocks can be recycled
+	AllocationBlock* blockToUse = FindBlockOfBestSize(requestedSize);
+
+	// if block can be recycled
+	if(blockToUse != nullptr)
+	{
+		return RecycleBlock( blockToUse, requestedSize);
+	}
+
+	// if here than ether no recyclable blocks are available or
+	// they are to small. Allocate from main block if a available
+	blockToUse = AllocateFromMainBlock( requestedSize );
+
+	// blocks waiting on quick lists may form block big enough once merged
+	if(blockToUse == nullptr && m_nrOfQuickBlocks != 0)
+	{
+		CoalesceQuickLists();
+		return AllocateBlock( requestedSize );
+	}
+
+	return blockToUse;
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to take block from quick lists, list of requested size
+// holds blocks up to QUICK_LIST_GRANULARITY - 1 bytes smaller or bigger
+// so its head is used if big enough, else head of next list is used
+DynamicAllocationSizePool::AllocationBlock*
+DynamicAllocationSizePool::TakeQuickBlock( size_t requestedSize )
+{
+	size_t index = requestedSize / QUICK_LIST_GRANULARITY;
+
+	for(size_t i = index; i < index + 2 && i < NR_OF_QUICK_LISTS; i++)
+	{
+		AllocationBlock* block = m_quickLists[i];
+		if(block != nullptr && block->allocSize >= requestedSize)
+		{
+#ifdef POOL_HARDENED
+			if(block->canary != (GetCanary( block ) ^ QUICK_BLOCK_TAG))
+			{
+				ReportCorruption( "Quick list block header corrupted", block + 1 );
+				return nullptr;
+			}
+			block->canary = GetCanary( block );
+#endif
+
+			m_quickLists[i] = block->LogicalNext;
+			block->LogicalNext = nullptr;
+
+			m_nrOfQuickBlocks--;
+			return block;
+		}
+	}
+
+	return nullptr;
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to put returned block on quick list of its size
+void
+DynamicAllocationSizePool::PutQuickBlock( AllocationBlock* block )
+{
+	size_t index = block->allocSize / QUICK_LIST_GRANULARITY;
+
+#ifdef POOL_HARDENED
+	block->canary = GetCanary( block ) ^ QUICK_BLOCK_TAG;
+#endif
+
+	block->LogicalNext = m_quickLists[index];
+	m_quickLists[index] = block;
+
+	m_nrOfQuickBlocks++;
+}
+///////////////////////////////////////////////////////////
+
+// Internal method returns allocated block, in deferred mode
+// small blocks are kept on quick lists for reuse
+void
+DynamicAllocationSizePool::ReturnBlock( AllocationBlock* returnedBlock )
+{
+#ifdef POOL_HARDENED
+	if(CheckReturnedBlock( returnedBlock ) == false)
+	{
+		return;
+	}
+#endif
+
+	m_nrOfAllocations--;
+	m_totalAllocated -= returnedBlock->allocSize;
+
+	// quick lists are coalesced once they grow to big
+	if(m_deferCoalescing && returnedBlock->allocSize < QUICK_LIST_LIMIT)
+	{
+		PutQuickBlock( returnedBlock );
+
+		if(m_nrOfQuickBlocks > QUICK_LIST_THRESHOLD)
+		{
+			CoalesceQuickLists();
+		}
+		return;
+	}
+
+	DeallocateBlock( returnedBlock );
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to return block into pool, block is merged
+// with free physical neighbours, if it ends up next to the end of
+// pool it becomes the main block else it goes to recycled list
+void
+DynamicAllocationSizePool::DeallocateBlock( AllocationBlock* returnedBlock )
+{
+	// update block flag 
+	returnedBlock->isAllocated = false;
+
+	// get preceding physical block
+	AllocationBlock* physicalPrev = returnedBlock->PhysicalPrevious;
+
+	// Check if preceding and returned block can be merged
+	if(physicalPrev != nullptr && physicalPrev->isAllocated == false)
+	{
+		//if preceding block exist and it is free than it must be on recycledBlocks list 
+		// Remove it from recycled list
+		m_recycledBlocks.Remove( physicalPrev );
+
+
+		// NOTE: because returnedBlock is at proceeding address 
+		// the merging operation will be done from "right to left" witch means the
+		// preceding block links and values are going to be updated and
+		// current block "returnedBlock" will be "abandoned"
+
+		// update preceding block size
+		physicalPrev->allocSize += (returnedBlock->allocSize + m_OVERHEAD);
+
+		// Update preceding block physical links
+		physicalPrev->PhysicalNext = returnedBlock->PhysicalNext;
+		if(physicalPrev->PhysicalNext != nullptr)
+		{
+			physicalPrev->PhysicalNext->PhysicalPrevious = physicalPrev;
+		}
+
+		// compaction and verification continue from the merged block
+		MoveCursors( returnedBlock, physicalPrev );
+
+		// after merging operation preceding block became larger 
+		// and links has been updated, store its address in returnedBlock pointer
+		returnedBlock = physicalPrev;
+
+		// update pool data members 
+		// overhead and block number is decremented as 
+		// blocks has been merged
+		m_totalOverhead -= m_OVERHEAD;
+		m_nrOfBlocks--;
+	}
+
+	// NOTE: if merging succeed returnedBlock pointer points to "new" bigger block else
+	// returnedBlock is "untouched" in ether case the check can be done to see if it
+	// can be merged with proceeding block
+
+	// Get proceeding block
+	AllocationBlock* physicalNext = returnedBlock->PhysicalNext;
+
+	// if physical next block is nullptr and the main block is also nullptr
+	// than current block "returnedBlock" must be the last physical block in pool, 
+	// therefore it will become the mainBlock and method will terminate
+	if(physicalNext == nullptr && m_mainBlock == nullptr)
+	{
+		// store current block address in mainBlock pointer
+		m_mainBlock = returnedBlock;
+
+		return;
+	}
+	else if(physicalNext == m_mainBlock)
+	{
+		// if here than next physical block is the m_mainBlock 
+		// witch means current block "returnedBlock" can be merged with it
+		// because the main block is at proceeding address the merging
+		// operation will be done from "right to left" therefore returned 
+		// block is going to become the mainBlock its links and values are going
+		// to be updated and method will terminate
+
+		// update current block size
+		returnedBlock->allocSize += (m_mainBlock->allocSize + m_OVERHEAD);
+
+		// set next physical block to nullptr as this block became the last physical block in pool
+		returnedBlock->PhysicalNext = nullptr;
+
+		MoveCursors( m_mainBlock, returnedBlock );
+
+		// store returnedBlock address in the mainBlock pointer
+		m_mainBlock = returnedBlock;
+ 
+		// update pool data members
+
+		// overhead and block number is decremented as 
+		// blocks has been merged
+		m_totalOverhead -= m_OVERHEAD;
+		m_nrOfBlocks--;
+
+		return;
+	}
+
+	else if(physicalNext != nullptr && physicalNext->isAllocated == false)
+	{
+		// if here than next physical block must be free and on recycledBlocks
+		// list witch means blocks can be merged, the merging operation
+		// will be done from "right to left" current block "returnedBlock" is at preceding address  
+		// and therefore its links and values are going to be updated, proceeding block will be "abandoned"
+		// merged block will be inserted back to the recycledBlocks list and method will terminate
+
+		// Remove proceeding block from recycled list
+		m_recycledBlocks.Remove( physicalNext );
+
+		// blocks Can be merged now
+
+		// update current block size
+		returnedBlock->allocSize += (physicalNext->allocSize + m_OVERHEAD);
+
+		// update its physical links
+		returnedBlock->PhysicalNext = physicalNext->PhysicalNext;
+		if(returnedBlock->PhysicalNext != nullptr)
+		{
+			returnedBlock->PhysicalNext->PhysicalPrevious = returnedBlock;
+		}
+
+		MoveCursors( physicalNext, returnedBlock );
+
+		// re-insert merged block to recycled list 
+		m_recycledBlocks.Insert( returnedBlock );
+
+		// update pool data members
+
+		// overhead and block number is decremented as 
+		// blocks has been merged
+		m_totalOverhead -= m_OVERHEAD;
+		m_nrOfBlocks--;
+
+		return;
+	}
+	else
+	{
+		// if here than block cannot be merged ether with previous 
+		// and/or with next block just insert it to recycled list 
+		m_recycledBlocks.Insert( returnedBlock );
+
+		return;
+	}
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to search through recycled 
+// blocks list for block of best possible size 
+// it searches through the list from front to back and back to front at the same time
+// to minimize search time and it will return ether a block of size exactly
+// as requested (if available) or the smallest block that allocation can be done from
+// if no such block is available it will return nullptr indicating that none of available
+// blocks are big enough to allocate from, or there is no blocks that can be recycled at all
+DynamicAllocationSizePool::AllocationBlock* 
+DynamicAllocationSizePool::FindBlockOfBestSize( size_t requestedSize) const
+{
+	AllocationBlock* tempFront = m_recycledBlocks.GetFirst();
+	AllocationBlock* tempBack = m_recycledBlocks.GetLast();
+	AllocationBlock* bestSoFar = nullptr;
+
+	// While there are blocks available
+	// the "back" pointer does not need to
+	// be checked as if there are any blocks
+	// on the list both pointers cannot be nullptr
+	while(tempFront != nullptr)
+	{
+		// If block size is exactly as requested there 
+		// is no need to search any more return the appropriate block
+		// this is first of two ways a while loop will terminate
+		if(tempFront->allocSize == requestedSize)
+		{
+			return tempFront;
+		}
+		else if(tempBack->allocSize == requestedSize)
+		{
+			return tempBack;
+		}
+		///////////////////////////////////////////
+
+		// if the search meet than size will be checked and if
 		// this is second way a while loop will terminate as if the search meet 
 		// than there is no more block to search through if any block meeting 
 		// the requirements has been found than it is stored in bestSoFar and
 		// will be returned  
 		if(tempFront == tempBack)
 		{
-			// If block is of right size
-			if(tempFront->allocSize >= requestedSize)
-			{
-				// if bestSoFar is nullptr than just store block
-				// pointer else check if size can be improved
-				if(bestSoFar == nullptr)
-				{
-					bestSoFar = tempFront;
-				}
-				else if(bestSoFar->allocSize > tempFront->allocSize)
-				{
-					bestSoFar = tempFront;
-				}
-			}
-			// nothing more to search
-			// this will be ether a block that memory can be allocated from
-			// or it will be nullptr indicating that no blocks can be recycled
-			return bestSoFar; 
+			// If block is of right size
+			if(tempFront->allocSize >= requestedSize)
+			{
+				// if bestSoFar is nullptr than just store block
+				// pointer else check if size can be improved
+				if(bestSoFar == nullptr)
+				{
+					bestSoFar = tempFront;
+				}
+				else if(bestSoFar->allocSize > tempFront->allocSize)
+				{
+					bestSoFar = tempFront;
+				}
+			}
+			// nothing more to search
+			// this will be ether a block that memory can be allocated from
+			// or it will be nullptr indicating that no blocks can be recycled
+			return bestSoFar; 
+		}
+		///////////////////////////////////////////////
+
+		// if front and back search blocks are of the right size, they will be compared and
+		// the block with the smaller size will be picked, next if the size of 
+		// chosen block will better than the size of current block stored in bestSoFar 
+		// than it will be picked and search will continue 
+		if(tempFront->allocSize >= requestedSize && tempBack->allocSize >= requestedSize)
+		{
+			// if back block is smaller
+			if(tempFront->allocSize > tempBack->allocSize)
+			{
+				// if bestSoFar is nullptr than just store block
+				// pointer else check if size can be improved 
+				if(bestSoFar == nullptr)
+				{
+					bestSoFar = tempBack;
+				}
+				else if(bestSoFar->allocSize > tempBack->allocSize)
+				{
+					bestSoFar = tempBack;
+				}
+			}
+			else // if front block is smaller
+			{
+				// if bestSoFar is nullptr than just store block
+				// pointer else check if size can be improved 
+				if(bestSoFar == nullptr)
+				{
+					bestSoFar = tempFront;
+				}
+				else if(bestSoFar->allocSize > tempFront->allocSize)
+				{
+					bestSoFar = tempFront;
+				}
+			}
+		}
+
+		// if front search block is of the right size check if 
+		// current bestSoFar can be improved 
+		else if(tempFront->allocSize >= requestedSize)
+		{
+			// if bestSoFar is nullptr than just store block
+			// pointer else check if size can be improved 
+			if(bestSoFar == nullptr)
+			{
+				bestSoFar = tempFront;
+			}
+			else if(bestSoFar->allocSize > tempFront->allocSize)
+			{
+				bestSoFar = tempFront;
+			}
+		}
+
+		// if back search block is of the right size check if 
+		// current bestSoFar can be improved 
+		else if(tempBack->allocSize >= requestedSize)
+		{
+			// if bestSoFar is nullptr than just store block
+			// pointer else check if size can be improved 
+			if(bestSoFar == nullptr)
+			{
+				bestSoFar = tempBack;
+			}
+			else if(bestSoFar->allocSize > tempBack->allocSize)
+			{
+				bestSoFar = tempBack;
+			}
+		}
+
+		// Get next Blocks 
+		tempFront = tempFront->LogicalNext;
+		tempBack = tempBack->LogicalPrevious;
+
+	}// while loop
+
+
+	// The search never get here however this return is placed to get rid of the C4715 warning
+	return bestSoFar;
+}
+///////////////////////////////////////////////////////////
+
+// Internal Method used to recycle block found on 
+// recycled blocks list.
+// method will split block if its big enough, and if
+// the block that is passed in will be used, newly
+// created block will be inserted back to recycledBlocks list 
+DynamicAllocationSizePool::AllocationBlock*
+DynamicAllocationSizePool::RecycleBlock(AllocationBlock* blockToUse, size_t requestedSize)
+{
+	// Remove block from recycled list
+	m_recycledBlocks.Remove( blockToUse );
+
+	// check if given block is big enough to be split, size after it is split must be 
+	// enough to allocate at least 4bytes after creating a new block
+	if(blockToUse->allocSize >= requestedSize && (blockToUse->allocSize - requestedSize) >= (m_OVERHEAD + 4))
+	{
+		// Calculate new size and address for new block, it will be created
+		// at the address of (blockToUse + allocationSize) 
+		char* address = (reinterpret_cast<char*>(blockToUse) + (m_OVERHEAD + requestedSize));
+		size_t newBlockSize = (blockToUse->allocSize - requestedSize - m_OVERHEAD);
+
+		// Create new block 
+		AllocationBlock* newBlock = CreateBlock( address, newBlockSize );
+
+		// update new block physical links
+		newBlock->PhysicalPrevious = blockToUse;
+		newBlock->PhysicalNext = blockToUse->PhysicalNext;
+		if(newBlock->PhysicalNext != nullptr)
+		{
+			newBlock->PhysicalNext->PhysicalPrevious = newBlock;
+		}
+
+		// insert newly created block back onto recycled blocks list
+		m_recycledBlocks.Insert(newBlock);
+
+		// update blockToUse physical links
+		blockToUse->PhysicalNext = newBlock;
+
+		// update its size and set as allocated
+		blockToUse->allocSize = requestedSize;
+		blockToUse->isAllocated = true; 
+
+		// update pool data members values 
+		// overhead and number of blocks is updated as 
+		// a new block was just created
+		m_totalOverhead += m_OVERHEAD;
+		m_nrOfBlocks++;
+
+		return blockToUse;
+	}
+	else // block is to small to be split, it will be used "as it is" 
+	{
+		blockToUse->isAllocated = true;
+
+		return blockToUse;
+	}
+
+	// this code will never be executed however it is placed here
+	// to get rid of the C4715 warning
+	return nullptr;
+}
+///////////////////////////////////////////////////////////
+
+// Internal method used to allocate block from main block,
+// main block is split if big enough else it is used "as it is"
+// returns nullptr if main block is not available or to small
+DynamicAllocationSizePool::AllocationBlock*
+DynamicAllocationSizePool::AllocateFromMainBlock( size_t requestedSize )
+{
+	if(m_mainBlock == nullptr)
+	{
+		return nullptr;
+	}
+
+	AllocationBlock* blockToUse = nullptr;
+
+	// check if space will be left after allocation, must be 
+	// enough to allocate at least 4bytes after creating new block
+	if(m_mainBlock->allocSize >= requestedSize && (m_mainBlock->allocSize - requestedSize) >= (m_OVERHEAD + 4))
+	{
+		// Calculate new size and address for mainBlock, it will be created
+		// at the address of (mainBlock + allocationSize) 
+		char* address = (reinterpret_cast<char*>(m_mainBlock) + m_OVERHEAD + requestedSize);
+		size_t newBlockSize = (m_mainBlock->allocSize - m_OVERHEAD - requestedSize);
+
+		// copy existing mainBlock address to the pointer of
+		// block that will be used and update its values 
+		blockToUse = m_mainBlock;
+		blockToUse->allocSize = requestedSize;
+		blockToUse->isAllocated = true;
+
+		// Create new mainBlock at previously calculated address 
+		m_mainBlock = CreateBlock( address, newBlockSize );
+
+		// memory behind new main block header is still untouched
+		if(reinterpret_cast<char*>(m_mainBlock + 1) > m_zeroWatermark)
+		{
+			m_zeroWatermark = reinterpret_cast<char*>(m_mainBlock + 1);
+		}
+
+		// update physical links
+		m_mainBlock->PhysicalPrevious = blockToUse;
+		blockToUse->PhysicalNext = m_mainBlock;
+
+		// Update values in pool data members
+		m_totalOverhead += m_OVERHEAD;
+		m_nrOfBlocks++;
+
+		return blockToUse;
+	}
+	// if mainBlock is big enough to allocate from it
+	// but not big enough to split it, than it will be used 
+	// "as it is" the mainBlock pointer will be set to nullptr
+	// indicating that there is no free space in main memory 
+	// however there still may be space available in recyclableBlocks list
+	else if(m_mainBlock->allocSize >= requestedSize)
+	{
+		blockToUse = m_mainBlock;
+		blockToUse->isAllocated = true;
+
+		m_mainBlock = nullptr;
+		m_zeroWatermark = reinterpret_cast<char*>(m_poolMemory) + m_poolSize;
+
+		return blockToUse;
+	}
+
+	return nullptr;
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to return space behind requested size of allocated
+// block into pool, space must be enough to hold new block with at least 4 bytes
+void
+DynamicAllocationSizePool::TrimBlock( AllocationBlock* block, size_t requestedSize )
+{
+	if(block->allocSize < requestedSize || (block->allocSize - requestedSize) < (m_OVERHEAD + 4))
+	{
+		return;
+	}
+
+	AllocationBlock* tailBlock = CreateBlock( reinterpret_cast<char*>(block) + m_OVERHEAD + requestedSize, block->allocSize - requestedSize - m_OVERHEAD );
+
+	tailBlock->PhysicalPrevious = block;
+	tailBlock->PhysicalNext = block->PhysicalNext;
+	if(tailBlock->PhysicalNext != nullptr)
+	{
+		tailBlock->PhysicalNext->PhysicalPrevious = tailBlock;
+	}
+
+	block->PhysicalNext = tailBlock;
+	block->allocSize = requestedSize;
+
+	m_totalOverhead += m_OVERHEAD;
+	m_nrOfBlocks++;
+
+	// tail merges with free block or main block behind it
+	DeallocateBlock( tailBlock );
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to create block of given size at given address in pool
+DynamicAllocationSizePool::AllocationBlock*
+DynamicAllocationSizePool::CreateBlock( char* atAddress, size_t size ) const
+{
+	AllocationBlock* block = reinterpret_cast<AllocationBlock*>(atAddress);
+	block->LogicalNext = nullptr;
+	block->LogicalPrevious = nullptr;
+	block->PhysicalNext = nullptr;
+	block->PhysicalPrevious = nullptr;
+
+	block->isAllocated = false;
+	block->allocSize = size;
+
+	block->isRelocatable = false;
+	block->handleIndex = 0;
+
+#ifdef POOL_HARDENED
+	block->canary = GetCanary( block );
+#endif
+
+	return block;
+}
+///////////////////////////////////////////////////////////
+
+// internal method moves relocatable block to the start of free block in front
+// of it, free space is recreated behind moved block and returned into pool
+// so it merges with free block or main block that follows
+DynamicAllocationSizePool::AllocationBlock*
+DynamicAllocationSizePool::SlideBlock( AllocationBlock* freeBlock, AllocationBlock* movedBlock )
+{
+	m_recycledBlocks.Remove( freeBlock );
+
+	// free block header is overwritten by moved block
+	AllocationBlock* physicalPrev = freeBlock->PhysicalPrevious;
+	AllocationBlock* physicalNext = movedBlock->PhysicalNext;
+	size_t freeSize = freeBlock->allocSize;
+
+	// ranges overlap when free block is smaller than moved block
+	memmove( freeBlock, movedBlock, m_OVERHEAD + movedBlock->allocSize );
+
+	AllocationBlock* block = freeBlock;
+	block->PhysicalPrevious = physicalPrev;
+	m_handles[block->handleIndex - 1].block = block;
+
+#ifdef POOL_HARDENED
+	block->canary = GetCanary( block );
+#endif
+
+	// old header of moved block is now inside moved data or free space
+	MoveCursors( movedBlock, block );
+
+	// memory behind moved block was used before so zero watermark is not changed
+	AllocationBlock* gapBlock = CreateBlock( reinterpret_cast<char*>(block + 1) + block->allocSize, freeSize );
+	gapBlock->PhysicalPrevious = block;
+	gapBlock->PhysicalNext = physicalNext;
+	if(physicalNext != nullptr)
+	{
+		physicalNext->PhysicalPrevious = gapBlock;
+	}
+	block->PhysicalNext = gapBlock;
+
+	// gap block stays at its address, blocks behind it are merged into it
+	DeallocateBlock( gapBlock );
+
+	return gapBlock;
+}
+///////////////////////////////////////////////////////////
+
+// internal method takes free handle table entry for given block, full table is
+// replaced by table twice as big allocated from the pool, table is not relocatable
+DynamicAllocationSizePool::Handle
+DynamicAllocationSizePool::TakeHandle( AllocationBlock* block )
+{
+	if(m_freeHandle == 0)
+	{
+		size_t nrOfHandles = (m_nrOfHandles == 0) ? INITIAL_NR_OF_HANDLES : m_nrOfHandles * 2;
+		if(nrOfHandles > UINT32_MAX)
+		{
+			nrOfHandles = UINT32_MAX;
+		}
+
+		if(nrOfHandles == m_nrOfHandles)
+		{
+			return INVALID_HANDLE;
+		}
+
+		AllocationBlock* tableBlock = AllocateBlock( nrOfHandles * sizeof( HandleEntry ) );
+		if(tableBlock == nullptr)
+		{
+			return INVALID_HANDLE;
+		}
+
+		HandleEntry* handles = reinterpret_cast<HandleEntry*>(tableBlock + 1);
+		m_totalOverhead += tableBlock->allocSize;
+
+		if(m_handles != nullptr)
+		{
+			memcpy( handles, m_handles, m_nrOfHandles * sizeof( HandleEntry ) );
+
+			AllocationBlock* oldTableBlock = reinterpret_cast<AllocationBlock*>(m_handles) - 1;
+			m_totalOverhead -= oldTableBlock->allocSize;
+			DeallocateBlock( oldTableBlock );
+		}
+
+		// new entries are linked in index order
+		for(size_t i = m_nrOfHandles; i < nrOfHandles; i++)
+		{
+			handles[i].block = nullptr;
+			handles[i].nextFree = (i + 1 < nrOfHandles) ? (i + 2) : 0;
+		}
+
+		m_freeHandle = m_nrOfHandles + 1;
+		m_handles = handles;
+		m_nrOfHandles = nrOfHandles;
+	}
+
+	Handle handle = (Handle)m_freeHandle;
+	m_freeHandle = m_handles[handle - 1].nextFree;
+	m_handles[handle - 1].block = block;
+
+	return handle;
+}
+///////////////////////////////////////////////////////////
+
+// internal method checks handle is in table and its entry holds a block
+bool
+DynamicAllocationSizePool::IsHandleLive( Handle handle ) const
+{
+	return handle != INVALID_HANDLE && handle <= m_nrOfHandles && m_handles[handle - 1].block != nullptr;
+}
+///////////////////////////////////////////////////////////
+
+// internal method keeps cursors of incremental passes on valid block headers
+void
+DynamicAllocationSizePool::MoveCursors( AllocationBlock* block, AllocationBlock* replacement )
+{
+	if(m_compactCursor == block)
+	{
+		m_compactCursor = replacement;
+	}
+
+	if(m_verifyCursor == block)
+	{
+		m_verifyCursor = replacement;
+	}
+}
+///////////////////////////////////////////////////////////
+
+// internal method checks single block, next block header is read
+// only after it was confirmed it lies where this block ends
+const char*
+DynamicAllocationSizePool::CheckBlock( AllocationBlock* block ) const
+{
+#ifdef POOL_HARDENED
+	if(block->canary != GetCanary( block ) && (block->isAllocated == false || block->canary != (GetCanary( block ) ^ QUICK_BLOCK_TAG)))
+	{
+		return "Block header corrupted";
+	}
+#endif
+
+	char* blockEnd = reinterpret_cast<char*>(block + 1);
+	char* poolEnd = reinterpret_cast<char*>(m_poolMemory) + m_poolSize;
+
+	if(blockEnd > poolEnd || block->allocSize > (size_t)(poolEnd - blockEnd))
+	{
+		return "Block size exceeds pool";
+	}
+	blockEnd += block->allocSize;
+
+	AllocationBlock* physicalNext = block->PhysicalNext;
+	if(physicalNext == nullptr)
+	{
+		if(blockEnd != poolEnd)
+		{
+			return "Last block does not end at pool end";
+		}
+	}
+	else
+	{
+		if(reinterpret_cast<char*>(physicalNext) != blockEnd)
+		{
+			return "Block size does not match next block";
+		}
+
+		if(physicalNext->PhysicalPrevious != block)
+		{
+			return "Physical links are not symmetric";
+		}
+
+		if(block->isAllocated == false && physicalNext->isAllocated == false)
+		{
+			return "Free blocks were not merged";
+		}
+	}
+
+	if(block == m_mainBlock && (block->isAllocated == true || physicalNext != nullptr))
+	{
+		return "Main block is not last free block";
+	}
+
+	if(block->isRelocatable == true &&
+	   (block->isAllocated == false || block->handleIndex == 0 || block->handleIndex > m_nrOfHandles || m_handles[block->handleIndex - 1].block != block))
+	{
+		return "Handle table does not match block";
+	}
+
+	if(block->isAllocated == true && IsInRun( block + 1 ))
+	{
+		SmallRun* run = reinterpret_cast<SmallRun*>(block + 1);
+
+#ifdef POOL_HARDENED
+		if(run->canary != GetCanary( run ))
+		{
+			return "Run header corrupted";
 		}
-		///////////////////////////////////////////////
+#endif
 
-		// if front and back search blocks are of the right size, they will be compared and
-		// the block with the smaller size will be picked, next if the size of 
-		// chosen block will better than the size of current block stored in bestSoFar 
-		// than it will be picked and search will continue 
-		if(tempFront->allocSize >= requestedSize && tempBack->allocSize >= requestedSize)
+		if(run->nrOfFreeSlots > run->nrOfSlots || run->untouchedSlot > reinterpret_cast<char*>(run) + RUN_SIZE)
 		{
-			// if back block is smaller
-			if(tempFront->allocSize > tempBack->allocSize)
-			{
-				// if bestSoFar is nullptr than just store block
-				// pointer else check if size can be improved 
-				if(bestSoFar == nullptr)
-				{
-					bestSoFar = tempBack;
-				}
-				else if(bestSoFar->allocSize > tempBack->allocSize)
-				{
-					bestSoFar = tempBack;
-				}
-			}
-			else // if front block is smaller
-			{
-				// if bestSoFar is nullptr than just store block
-				// pointer else check if size can be improved 
-				if(bestSoFar == nullptr)
-				{
-					bestSoFar = tempFront;
-				}
-				else if(bestSoFar->allocSize > tempFront->allocSize)
-				{
-					bestSoFar = tempFront;
-				}
-			}
+			return "Run header corrupted";
 		}
+	}
 
-		// if front search block is of the right size check if 
-		// current bestSoFar can be improved 
-		else if(tempFront->allocSize >= requestedSize)
+	return nullptr;
+}
+///////////////////////////////////////////////////////////
+
+#ifdef POOL_HARDENED
+// internal method checks returned block before its neighbours are merged with it,
+// neighbour headers are read by merging anyway so checking them is cheap
+bool
+DynamicAllocationSizePool::CheckReturnedBlock( AllocationBlock* block ) const
+{
+	if(block->canary != GetCanary( block ))
+	{
+		ReportCorruption( (block->canary == (GetCanary( block ) ^ QUICK_BLOCK_TAG)) ? "Double free" : "Block header corrupted", block + 1 );
+		return false;
+	}
+
+	if(block->isAllocated == false)
+	{
+		ReportCorruption( "Double free", block + 1 );
+		return false;
+	}
+
+	AllocationBlock* physicalPrev = block->PhysicalPrevious;
+	AllocationBlock* physicalNext = block->PhysicalNext;
+
+	// canary is checked before links of neighbour are read
+	if((physicalPrev != nullptr && ((physicalPrev->canary | QUICK_BLOCK_TAG) != (GetCanary( physicalPrev ) | QUICK_BLOCK_TAG) || physicalPrev->PhysicalNext != block)) ||
+	   (physicalNext != nullptr && ((physicalNext->canary | QUICK_BLOCK_TAG) != (GetCanary( physicalNext ) | QUICK_BLOCK_TAG) || physicalNext->PhysicalPrevious != block)))
+	{
+		ReportCorruption( "Neighbour block header corrupted", block + 1 );
+		return false;
+	}
+
+	return true;
+}
+///////////////////////////////////////////////////////////
+#endif // if hardened
+
+
+
+// Internal method clears bytes of given range that lie below
+// zero watermark, watermark must be taken before range was allocated
+void
+DynamicAllocationSizePool::ClearUsedBytes( char* address, size_t size, char* zeroFrom ) const
+{
+	if(address < zeroFrom)
+	{
+		size_t usedBytes = (size_t)(zeroFrom - address);
+		memset( address, 0, (usedBytes < size) ? usedBytes : size );
+	}
+}
+///////////////////////////////////////////////////////////
+
+//*******************************************************************************//
+
+//*************************** Small Runs Definitions ***************************//
+
+// Method allocates slot from run of matching size class,
+// new run is created if all runs of that class are full
+// returns nullptr if no run can be created
+void*
+DynamicAllocationSizePool::AllocateSlot( size_t requestedSize )
+{
+	size_t sizeClass = (requestedSize == 0) ? 0 : ((requestedSize - 1) / SMALL_SIZE_GRANULARITY);
+
+	SmallRun* run = m_smallRuns[sizeClass];
+	if(run == nullptr)
+	{
+		run = CreateRun( sizeClass );
+		if(run == nullptr)
 		{
-			// if bestSoFar is nullptr than just store block
-			// pointer else check if size can be improved 
-			if(bestSoFar == nullptr)
-			{
-				bestSoFar = tempFront;
-			}
-			else if(bestSoFar->allocSize > tempFront->allocSize)
-			{
-				bestSoFar = tempFront;
-			}
+			return nullptr;
 		}
+	}
 
-		// if back search block is of the right size check if 
-		// current bestSoFar can be improved 
-		else if(tempBack->allocSize >= requestedSize)
+	// reuse returned slots first, than hand out never used ones
+	void* slot = run->freeSlots;
+	if(slot != nullptr)
+	{
+#ifdef POOL_HARDENED
+		// decoded link must point into the same run
+		void* nextSlot = EncodeLink( *reinterpret_cast<void**>(slot), slot, m_hardeningKey );
+		if(nextSlot != nullptr && (reinterpret_cast<uintptr_t>(nextSlot) & ~(uintptr_t)(RUN_SIZE - 1)) != reinterpret_cast<uintptr_t>(run))
 		{
-			// if bestSoFar is nullptr than just store block
-			// pointer else check if size can be improved 
-			if(bestSoFar == nullptr)
-			{
-				bestSoFar = tempBack;
-			}
-			else if(bestSoFar->allocSize > tempBack->allocSize)
-			{
-				bestSoFar = tempBack;
-			}
+			ReportCorruption( "Free slot link corrupted", slot );
+			return nullptr;
 		}
+		run->freeSlots = nextSlot;
+#else
+		run->freeSlots = *reinterpret_cast<void**>(slot);
+#endif
+	}
+	else
+	{
+		slot = run->untouchedSlot;
+		run->untouchedSlot += run->slotSize;
+	}
 
-		// Get next Blocks 
-		tempFront = tempFront->LogicalNext;
-		tempBack = tempBack->LogicalPrevious;
+#ifdef POOL_HARDENED
+	size_t granule = (size_t)(reinterpret_cast<char*>(slot) - reinterpret_cast<char*>(run)) / SMALL_SIZE_GRANULARITY;
+	run->allocatedSlots[granule / 8] |= (unsigned char)(1 << (granule % 8));
+#endif
 
-	}// while loop
+	// full runs are not kept on the list
+	run->nrOfFreeSlots--;
+	if(run->nrOfFreeSlots == 0)
+	{
+		UnlinkRun( run );
+	}
 
+	m_totalAllocated += run->slotSize;
+	m_nrOfAllocations++;
 
-	// The search never get here however this return is placed to get rid of the C4715 warning
-	return bestSoFar;
+	return slot;
 }
 ///////////////////////////////////////////////////////////
 
-// Internal Method used to recycle block found on 
-// recycled blocks list.
-// method will split block if its big enough, and if
-// the block that is passed in will be used, newly
-// created block will be inserted back to recycledBlocks list 
-void* 
-DynamicAllocationSizePool::RecycleBlock(AllocationBlock* blockToUse, size_t requestedSize)
+// Method returns slot into its run, run header is found by masking the
+// address as runs are RUN_SIZE aligned, empty run is returned into pool
+// unless it is the only run with free slots left for its size class
+void
+DynamicAllocationSizePool::DeallocateSlot( void* address )
 {
-	// Remove block from recycled list
-	m_recycledBlocks.Remove( blockToUse );
+	SmallRun* run = reinterpret_cast<SmallRun*>(reinterpret_cast<uintptr_t>(address) & ~(uintptr_t)(RUN_SIZE - 1));
 
-	// check if given block is big enough to be split, size after it is split must be 
-	// enough to allocate at least 4bytes after creating a new block
-	if(((int)(blockToUse->allocSize - requestedSize)) >= ((int)(m_OVERHEAD + 4)))
+#ifdef POOL_HARDENED
+	if(run->canary != GetCanary( run ))
 	{
-		// Calculate new size and address for new block, it will be created
-		// at the address of (blockToUse + allocationSize) 
-		char* address = (reinterpret_cast<char*>(blockToUse) + (m_OVERHEAD + requestedSize));
-		size_t newBlockSize = (blockToUse->allocSize - requestedSize - m_OVERHEAD);
+		ReportCorruption( "Run header corrupted", address );
+		return;
+	}
 
-		// Create new block 
-		AllocationBlock* newBlock = CreateBlock( address, newBlockSize );
+	// address that is not start of allocated slot has its bit clear as well
+	size_t granule = (size_t)(reinterpret_cast<char*>(address) - reinterpret_cast<char*>(run)) / SMALL_SIZE_GRANULARITY;
+	unsigned char mask = (unsigned char)(1 << (granule % 8));
+	if((run->allocatedSlots[granule / 8] & mask) == 0 || (reinterpret_cast<uintptr_t>(address) % SMALL_SIZE_GRANULARITY) != 0)
+	{
+		ReportCorruption( "Double free or address is not start of slot", address );
+		return;
+	}
+	run->allocatedSlots[granule / 8] &= (unsigned char)~mask;
 
-		// update new block physical links
-		newBlock->PhysicalPrevious = blockToUse;
-		newBlock->PhysicalNext = blockToUse->PhysicalNext;
-		if(newBlock->PhysicalNext != nullptr)
+	*reinterpret_cast<void**>(address) = EncodeLink( run->freeSlots, address, m_hardeningKey );
+#else
+	*reinterpret_cast<void**>(address) = run->freeSlots;
+#endif
+	run->freeSlots = address;
+
+	m_totalAllocated -= run->slotSize;
+	m_nrOfAllocations--;
+
+	run->nrOfFreeSlots++;
+	if(run->nrOfFreeSlots == 1)
+	{
+		LinkRun( run );
+	}
+
+	if(run->nrOfFreeSlots == run->nrOfSlots && (run->next != nullptr || run->previous != nullptr))
+	{
+		UnlinkRun( run );
+		ReleaseRun( run );
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Method carves RUN_SIZE aligned run from main block, if main block data does not
+// start at run boundary the gap in front of the run becomes a free block on recycled list
+// first call also allocates run map. Returns nullptr if main block is to small
+DynamicAllocationSizePool::SmallRun*
+DynamicAllocationSizePool::CreateRun( size_t sizeClass )
+{
+	if(m_runMap == nullptr)
+	{
+		// run map holds one bit for every page pool memory spans
+		char* poolStart = reinterpret_cast<char*>(m_poolMemory);
+		m_runMapBase = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(poolStart) & ~(uintptr_t)(RUN_SIZE - 1));
+
+		size_t nrOfPages = (((poolStart + m_poolSize) - m_runMapBase) + RUN_SIZE - 1) / RUN_SIZE;
+		size_t mapSize = (nrOfPages + 7) / 8;
+
+		// keeps blocks following the map aligned same as the slots
+		mapSize = ((mapSize + SMALL_SIZE_GRANULARITY - 1) / SMALL_SIZE_GRANULARITY) * SMALL_SIZE_GRANULARITY;
+
+		char* zeroFrom = m_zeroWatermark;
+		AllocationBlock* mapBlock = AllocateBlock( mapSize );
+		if(mapBlock == nullptr)
 		{
-			newBlock->PhysicalNext->PhysicalPrevious = newBlock;
+			return nullptr;
 		}
 
-		// insert newly created block back onto recycled blocks list
-		m_recycledBlocks.Insert(newBlock);
+		m_runMap = reinterpret_cast<unsigned char*>(mapBlock + 1);
+		ClearUsedBytes( reinterpret_cast<char*>(m_runMap), mapSize, zeroFrom );
 
-		// update blockToUse physical links
-		blockToUse->PhysicalNext = newBlock;
+		m_totalOverhead += mapBlock->allocSize;
+	}
 
-		// update its size and set as allocated
-		blockToUse->allocSize = requestedSize;
-		blockToUse->isAllocated = true; 
+	if(m_mainBlock == nullptr)
+	{
+		return nullptr;
+	}
 
-		// update pool data members values 
-		// overhead and number of blocks is updated as 
-		// a new block was just created
-		m_totalOverhead += m_OVERHEAD;
-		m_nrOfBlocks++;
+	// find first run boundary that leaves either no gap or
+	// gap big enough to hold a block after main block header
+	char* dataStart = reinterpret_cast<char*>(m_mainBlock) + m_OVERHEAD;
+	char* runAddress = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(dataStart) + RUN_SIZE - 1) & ~(uintptr_t)(RUN_SIZE - 1));
 
-		m_totalAllocated += requestedSize;
-		m_nrOfAllocations++;
+	if(runAddress != dataStart && (size_t)(runAddress - dataStart) < (m_OVERHEAD + 4))
+	{
+		runAddress += RUN_SIZE;
+	}
 
-		return (++blockToUse);
+	if(m_mainBlock->allocSize < (size_t)(runAddress - dataStart) + RUN_SIZE)
+	{
+		return nullptr;
 	}
-	else // block is to small to be split, it will be used "as it is" 
+
+	// gap in front of the run is recycled, main block is big enough
+	// to be split after it so block before run is always free standing
+	if(runAddress != dataStart)
 	{
-		blockToUse->isAllocated = true;
-		m_totalAllocated += requestedSize;
-		m_nrOfAllocations++;
+		AllocationBlock* gapBlock = AllocateFromMainBlock( runAddress - dataStart - m_OVERHEAD );
+		gapBlock->isAllocated = false;
+		m_recycledBlocks.Insert( gapBlock );
+	}
 
-		return (++blockToUse);
+	AllocationBlock* runBlock = AllocateFromMainBlock( RUN_SIZE );
+	assert( reinterpret_cast<char*>(runBlock + 1) == runAddress && "Run is not aligned" );
+
+	SmallRun* run = reinterpret_cast<SmallRun*>(runAddress);
+	size_t headerSize = ((sizeof( SmallRun ) + SMALL_SIZE_GRANULARITY - 1) / SMALL_SIZE_GRANULARITY) * SMALL_SIZE_GRANULARITY;
+
+	run->next = nullptr;
+	run->previous = nullptr;
+	run->freeSlots = nullptr;
+	run->untouchedSlot = runAddress + headerSize;
+	run->slotSize = (sizeClass + 1) * SMALL_SIZE_GRANULARITY;
+	run->sizeClass = sizeClass;
+	run->nrOfSlots = (RUN_SIZE - headerSize) / run->slotSize;
+	run->nrOfFreeSlots = run->nrOfSlots;
+
+#ifdef POOL_HARDENED
+	run->canary = GetCanary( run );
+	memset( run->allocatedSlots, 0, sizeof( run->allocatedSlots ) );
+#endif
+
+	// run header and space not used by slots is counted as overhead
+	m_totalOverhead += runBlock->allocSize - (run->nrOfSlots * run->slotSize);
+
+	MarkRun( runAddress, true );
+	LinkRun( run );
+
+	return run;
+}
+///////////////////////////////////////////////////////////
+
+// Method returns empty run into pool as ordinary block
+void
+DynamicAllocationSizePool::ReleaseRun( SmallRun* run )
+{
+	MarkRun( run, false );
+
+	AllocationBlock* runBlock = reinterpret_cast<AllocationBlock*>(run);
+	runBlock--;
+
+	m_totalOverhead -= runBlock->allocSize - (run->nrOfSlots * run->slotSize);
+
+	DeallocateBlock( runBlock );
+}
+///////////////////////////////////////////////////////////
+
+// Method checks run map bit of page given address is in
+bool
+DynamicAllocationSizePool::IsInRun( void* address ) const
+{
+	char* bytePtr = reinterpret_cast<char*>(address);
+
+	if(m_runMap == nullptr || bytePtr < m_runMapBase ||
+	   bytePtr >= (reinterpret_cast<char*>(m_poolMemory) + m_poolSize))
+	{
+		return false;
 	}
 
-	// this code will never be executed however it is placed here
-	// to get rid of the C4715 warning
-	return nullptr;
+	size_t page = (size_t)(bytePtr - m_runMapBase) / RUN_SIZE;
+	return (m_runMap[page / 8] & (1 << (page % 8))) != 0;
 }
 ///////////////////////////////////////////////////////////
 
-// internal method used to create block of given size at given address in pool
-DynamicAllocationSizePool::AllocationBlock*
-DynamicAllocationSizePool::CreateBlock( char* atAddress, size_t size ) const
+// Method updates run map bit of page run is placed at
+void
+DynamicAllocationSizePool::MarkRun( void* runAddress, bool isRun )
 {
-	AllocationBlock* block = reinterpret_cast<AllocationBlock*>(atAddress);
-	block->LogicalNext = nullptr;
-	block->LogicalPrevious = nullptr;
-	block->PhysicalNext = nullptr;
-	block->PhysicalPrevious = nullptr;
+	size_t page = (size_t)(reinterpret_cast<char*>(runAddress) - m_runMapBase) / RUN_SIZE;
 
-	block->isAllocated = false;
-	block->allocSize = size;
+	if(isRun)
+	{
+		m_runMap[page / 8] |= (unsigned char)(1 << (page % 8));
+	}
+	else
+	{
+		m_runMap[page / 8] &= (unsigned char)~(1 << (page % 8));
+	}
+}
+///////////////////////////////////////////////////////////
 
-	return block;
+// Method inserts run at the front of its size class list
+void
+DynamicAllocationSizePool::LinkRun( SmallRun* run )
+{
+	SmallRun*& head = m_smallRuns[run->sizeClass];
+
+	run->previous = nullptr;
+	run->next = head;
+	if(head != nullptr)
+	{
+		head->previous = run;
+	}
+	head = run;
 }
 ///////////////////////////////////////////////////////////
 
+// Method removes run from its size class list
+void
+DynamicAllocationSizePool::UnlinkRun( SmallRun* run )
+{
+	if(run->previous != nullptr)
+	{
+		run->previous->next = run->next;
+	}
+	else
+	{
+		m_smallRuns[run->sizeClass] = run->next;
+	}
+
+	if(run->next != nullptr)
+	{
+		run->next->previous = run->previous;
+	}
+
+	run->next = nullptr;
+	run->previous = nullptr;
+}
+///////////////////////////////////////////////////////////
 
 
 //*******************************************************************************//
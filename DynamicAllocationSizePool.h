@@ -7,6 +7,7 @@
 
 #include "MemoryPool.h"
 #include <assert.h>
+#include <cstdint>
 #include <string>
 
 
@@ -22,6 +23,30 @@
 //				previously allocated memory to delete it
 
 //	NOTE:		Minimum pool and memory size must be at least 28 bytes
+//				Requests up to SMALL_ALLOCATION_LIMIT bytes are served from
+//				page sized runs of equally sized slots carved from main block,
+//				slots do not carry any header, owning run is found by masking
+//				the address and checking the run map
+//				When deferred coalescing is enabled returned blocks smaller
+//				than QUICK_LIST_LIMIT are kept on per size quick lists and
+//				reused as they are, they are merged with their neighbours in
+//				one batch when quick lists grow past QUICK_LIST_THRESHOLD
+//				blocks or when request cannot be satisfied without them
+//				Memory allocated with AllocateRelocatable is referenced through
+//				handle and may be moved by Compact, its address is only valid
+//				until next call to Compact. Compact slides relocatable blocks
+//				towards pool start so free space merges into main block, every
+//				call visits at most given number of blocks and continues where
+//				previous call stopped. Blocks allocated with Allocate, runs and
+//				handle table are never moved, free space can not pass them
+//				TryAllocateAligned takes block big enough to hold aligned memory
+//				and returns space in front of and behind it into pool
+//				When built with POOL_HARDENED block and run headers carry canary,
+//				free slot links are encoded, runs keep bit per allocated slot and
+//				returned blocks and their neighbours are checked before merging,
+//				corruption is passed to MemoryPool corruption handler
+//				SharedDynamicAllocationSizePool keeps offset linked copy of best
+//				fit, split and merge, changes to them have to be made in both
 
 class DynamicAllocationSizePool: public MemoryPool
 {
@@ -31,6 +56,14 @@ private: // Structures
 	struct AllocationBlock
 	{
 	public:
+#ifdef POOL_HARDENED
+		// block address encoded with pool key, header is not trusted if it does
+		// not match, placed first so overflow of previous block overwrites it
+		uintptr_t canary;
+		// keeps header size multiple of 16 so memory behind it stays aligned
+		uintptr_t padding;
+#endif
+
 		AllocationBlock* LogicalNext;
 		AllocationBlock* LogicalPrevious;
 
@@ -39,7 +72,13 @@ private: // Structures
 
 		size_t allocSize;
 		bool isAllocated;
+
+		// true if block is referenced through handle and may be moved,
+		// handleIndex is index of its handle table entry + 1
+		bool isRelocatable;
+		uint32_t handleIndex;
 	};
+	static_assert( (sizeof( AllocationBlock ) % 16) == 0, "Block header must keep memory behind it 16 byte aligned" );
 	//********************************************************//
 
 	// semantic structure defines recycled blocks linked list 
@@ -65,32 +104,212 @@ private: // Structures
 	};
 	//********************************************************//
 
+	// Small allocation constants
+	static const size_t SMALL_ALLOCATION_LIMIT = 256;
+	static const size_t SMALL_SIZE_GRANULARITY = 16;
+	static const size_t NR_OF_SMALL_CLASSES = SMALL_ALLOCATION_LIMIT / SMALL_SIZE_GRANULARITY;
+	static const size_t RUN_SIZE = 4096;
+
+	// semantic structure defines run of equally sized slots used
+	// for small allocations, placed at the start of RUN_SIZE aligned page
+	struct SmallRun
+	{
+	public:
+		SmallRun* next;
+		SmallRun* previous;
+
+		// singly linked list of returned slots
+		void* freeSlots;
+		// first slot that has never been handed out
+		char* untouchedSlot;
+
+		size_t slotSize;
+		size_t sizeClass;
+		size_t nrOfSlots;
+		size_t nrOfFreeSlots;
+
+#ifdef POOL_HARDENED
+		// run address encoded with pool key
+		uintptr_t canary;
+		// bit per SMALL_SIZE_GRANULARITY bytes of run, set for first granule of allocated slot
+		unsigned char allocatedSlots[RUN_SIZE / SMALL_SIZE_GRANULARITY / 8];
+#endif
+	};
+	//********************************************************//
+
+	// handle table entry, block is nullptr while entry is free so
+	// stale handle is recognised before its block is touched
+	struct HandleEntry
+	{
+		AllocationBlock* block;
+		// index of next free entry + 1, 0 if it is last free entry
+		size_t nextFree;
+	};
+	//********************************************************//
+
+	// Deferred coalescing constants
+	static const size_t QUICK_LIST_GRANULARITY = 16;
+	static const size_t QUICK_LIST_LIMIT = 2048;
+	static const size_t NR_OF_QUICK_LISTS = QUICK_LIST_LIMIT / QUICK_LIST_GRANULARITY;
+	static const size_t QUICK_LIST_THRESHOLD = 256;
+
+#ifdef POOL_HARDENED
+	// canary of block waiting on quick list is marked with this bit
+	// so returning it again is recognised as double free
+	static const uintptr_t QUICK_BLOCK_TAG = 1;
+#endif
+
+	// Handle table constants
+	static const size_t INITIAL_NR_OF_HANDLES = 64;
+
+public: // Types
+
+	// Handle of relocatable allocation, INVALID_HANDLE is never returned for live allocation
+	typedef uint32_t Handle;
+	static const Handle INVALID_HANDLE = 0;
+
 public: // Methods
 
 	// Constructor
-	DynamicAllocationSizePool(void* memory,size_t poolSize, std::string poolID);
+	DynamicAllocationSizePool(void* memory,size_t poolSize, std::string poolID, bool deferCoalescing = false, bool memoryIsZeroed = false);
 	// Destructor
 	virtual ~DynamicAllocationSizePool(void);
 
 	// Methods used to allocate and free memory
 	virtual void* Allocate( size_t requestedSize);
 	virtual void Deallocate( void* address );
+	virtual void Deallocate( void* address, size_t size );
+
+	// Allocates memory, returns nullptr if request cannot be satisfied
+	virtual void* TryAllocate( size_t requestedSize );
+
+	// Allocates zero filled memory, only bytes that were used before are cleared
+	virtual void* AllocateZeroed( size_t requestedSize );
+	void* TryAllocateZeroed( size_t requestedSize );
+
+	// Allocates memory aligned to given power of two, returns nullptr
+	// if request cannot be satisfied, memory is returned with Deallocate
+	void* TryAllocateAligned( size_t requestedSize, size_t alignment );
+
+	// Returns number of bytes usable at previously allocated address
+	size_t GetAllocationSize( void* address ) const;
 
 	// Returns total size of overhead
 	virtual size_t GetTotalOverhead(void) const { return m_totalOverhead; }
 
+	// Returns size of largest free block, walks recycled list
+	virtual size_t GetLargestFreeBlock(void) const;
+
+	// Merges all blocks kept on quick lists with their neighbours
+	void CoalesceQuickLists(void);
+
+	// Returns true if deferred coalescing is enabled
+	bool IsCoalescingDeferred(void) const { return m_deferCoalescing; }
+
+	// Allocates memory that Compact may move, TryAllocateRelocatable
+	// returns INVALID_HANDLE if request cannot be satisfied
+	Handle AllocateRelocatable( size_t requestedSize );
+	Handle TryAllocateRelocatable( size_t requestedSize );
+
+	// Returns relocatable memory into pool, returned or unknown handle is
+	// ignored after assert or after corruption is reported in hardened mode
+	void DeallocateRelocatable( Handle handle );
+
+	// Returns current address of relocatable memory, valid until next Compact,
+	// nullptr for returned or unknown handle
+	void* GetAddress( Handle handle ) const;
+
+	// Moves relocatable blocks into free space in front of them visiting at most
+	// maxBlocks blocks, returns true once pass over the whole pool is finished
+	bool Compact( size_t maxBlocks );
+
+	// Verifies headers and physical links of at most maxBlocks blocks
+	virtual bool VerifyHeap( size_t maxBlocks );
+
 private: // internal methods
 
+	// Method allocates block of requested size, returns nullptr if
+	// request cannot be satisfied, allocation counters are not updated
+	AllocationBlock* AllocateBlock( size_t requestedSize );
+
+	// Method returns block into pool and merges it with free neighbours,
+	// allocation counters are not updated
+	void DeallocateBlock( AllocationBlock* returnedBlock );
+
+	// Method returns allocated block, updates allocation counters
+	// and puts block on quick list when coalescing is deferred
+	void ReturnBlock( AllocationBlock* returnedBlock );
+
+	// Methods used to take block of matching size from / put block on quick lists
+	AllocationBlock* TakeQuickBlock( size_t requestedSize );
+	void PutQuickBlock( AllocationBlock* block );
+
 	// Method used to find block of best size in recycled block list  
 	AllocationBlock* FindBlockOfBestSize( size_t requestedSize ) const;
 
 	// Method used to recycle block found by method above 
-	void* RecycleBlock( AllocationBlock* blockToUse, size_t requestedSize);
+	AllocationBlock* RecycleBlock( AllocationBlock* blockToUse, size_t requestedSize);
+
+	// Method used to allocate block from the front of main block
+	AllocationBlock* AllocateFromMainBlock( size_t requestedSize );
+
+	// Method splits free block off the end of allocated block if
+	// it is big enough, block is left with requested size
+	void TrimBlock( AllocationBlock* block, size_t requestedSize );
 
 	// Method creates new block of given size at given address given size,
 	// sets all links to nullptr, new block "isAllocated" member is set to false
 	AllocationBlock* CreateBlock( char* atAddress, size_t size ) const;
 
+	// Method moves relocatable block into free block directly in front of it,
+	// returns free block that ends up behind moved block
+	AllocationBlock* SlideBlock( AllocationBlock* freeBlock, AllocationBlock* movedBlock );
+
+	// Method moves compaction and verification cursors from block
+	// that stops being block header to block replacing it
+	void MoveCursors( AllocationBlock* block, AllocationBlock* replacement );
+
+	// Method checks block header and its links to next block,
+	// returns description of first problem found or nullptr
+	const char* CheckBlock( AllocationBlock* block ) const;
+
+#ifdef POOL_HARDENED
+	// Method returns canary of header at given address
+	uintptr_t GetCanary( const void* header ) const { return m_hardeningKey ^ reinterpret_cast<uintptr_t>(header); }
+
+	// Method checks block returned by user and its physical neighbours
+	// before they are merged, returns false if corruption was reported
+	bool CheckReturnedBlock( AllocationBlock* block ) const;
+#endif
+
+	// Method takes free handle table entry, table grows when full,
+	// returns INVALID_HANDLE if bigger table cannot be allocated
+	Handle TakeHandle( AllocationBlock* block );
+
+	// Method returns true if handle refers to live relocatable allocation
+	bool IsHandleLive( Handle handle ) const;
+
+	// Method zeroes part of range below given zero watermark
+	void ClearUsedBytes( char* address, size_t size, char* zeroFrom ) const;
+
+	// Methods used to allocate and free slots of small runs
+	void* AllocateSlot( size_t requestedSize );
+	void DeallocateSlot( void* address );
+
+	// Method carves new run for given size class from main block
+	SmallRun* CreateRun( size_t sizeClass );
+	// Method returns empty run into pool
+	void ReleaseRun( SmallRun* run );
+
+	// Method returns true if address belongs to one of small runs
+	bool IsInRun( void* address ) const;
+	// Method sets or clears run map bit of page starting at given address
+	void MarkRun( void* runAddress, bool isRun );
+
+	// Methods link / unlink run into list of runs with free slots
+	void LinkRun( SmallRun* run );
+	void UnlinkRun( SmallRun* run );
+
 private: // Members
 
 	// Pointer to "main" block
@@ -106,4 +325,45 @@ private: // Members
 
 	// cached total overhead size in bytes
 	size_t m_totalOverhead;
+
+	// runs with free slots, one list per size class
+	SmallRun* m_smallRuns[NR_OF_SMALL_CLASSES];
+
+	// bit per RUN_SIZE page of pool memory, set if page holds a run,
+	// allocated from the pool with first run
+	unsigned char* m_runMap;
+	// address of first page covered by run map
+	char* m_runMapBase;
+
+	// true if returned blocks are coalesced in batches
+	bool m_deferCoalescing;
+
+	// returned blocks waiting to be coalesced, linked through LogicalNext
+	// blocks keep isAllocated flag set so neighbours do not merge with them
+	AllocationBlock* m_quickLists[NR_OF_QUICK_LISTS];
+
+	// number of blocks on all quick lists
+	size_t m_nrOfQuickBlocks;
+
+	// pool memory from this address on has never been written,
+	// pool end if memory was not zeroed when pool was created
+	char* m_zeroWatermark;
+
+	// handle table, allocated from the pool with first relocatable allocation
+	HandleEntry* m_handles;
+	size_t m_nrOfHandles;
+	// index of first free handle table entry + 1, 0 if table is full
+	size_t m_freeHandle;
+
+	// block Compact continues from, nullptr if no pass is in progress,
+	// moved to surviving block when block it points to is merged
+	AllocationBlock* m_compactCursor;
+
+	// block VerifyHeap continues from, nullptr if no pass is in progress
+	AllocationBlock* m_verifyCursor;
+
+#ifdef POOL_HARDENED
+	// key canaries and free slot links are encoded with
+	uintptr_t m_hardeningKey;
+#endif
 };
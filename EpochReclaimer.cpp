@@ -0,0 +1,275 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "EpochReclaimer.h"
+
+#include <assert.h>
+
+namespace
+{
+	// source of reclaimer IDs, ID is never reused so cached
+	// record of destroyed reclaimer is never matched
+	std::atomic<uint64_t> g_nextReclaimerId( 1 );
+
+	// last record used by calling thread
+	thread_local uint64_t t_cachedReclaimerId = 0;
+	thread_local void* t_cachedRecord = nullptr;
+}
+
+// Constructor
+EpochReclaimer::EpochReclaimer( MemoryPool* pool, size_t linkOffset ):
+	m_pool( pool ),
+	m_linkOffset( linkOffset ),
+	m_reclaimerId( g_nextReclaimerId.fetch_add( 1, std::memory_order_relaxed ) ),
+	m_globalEpoch( 2 ),
+	m_records( nullptr ),
+	m_nrOfRetired( 0 )
+{
+	assert( pool != nullptr && "Pool must be provided" );
+}
+///////////////////////////////////////////////////////////
+
+// Destructor
+EpochReclaimer::~EpochReclaimer(void)
+{
+	ThreadRecord* record = m_records.load( std::memory_order_acquire );
+
+	while(record != nullptr)
+	{
+		assert( record->guardDepth == 0 && "Reclaimer destroyed while thread is inside a Guard" );
+
+		for(size_t i = 0; i < 3; i++)
+		{
+			ReturnBlocks( record->limbo[i] );
+		}
+
+		ThreadRecord* next = record->next;
+		delete record;
+		record = next;
+	}
+
+	if(t_cachedReclaimerId == m_reclaimerId)
+	{
+		t_cachedReclaimerId = 0;
+		t_cachedRecord = nullptr;
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Method marks calling thread as reading in current epoch
+void
+EpochReclaimer::Enter(void)
+{
+	ThreadRecord* record = GetThreadRecord();
+
+	if(record->guardDepth++ == 0)
+	{
+		// store must be visible before any shared memory is read
+		uint64_t epoch = m_globalEpoch.load( std::memory_order_acquire );
+		record->localEpoch.store( (epoch << 1) | 1, std::memory_order_seq_cst );
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Method marks calling thread as no longer reading
+void
+EpochReclaimer::Leave(void)
+{
+	ThreadRecord* record = GetThreadRecord();
+
+	assert( record->guardDepth > 0 && "Leave called without Enter" );
+
+	if(--record->guardDepth == 0)
+	{
+		record->localEpoch.store( 0, std::memory_order_release );
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Method links memory into limbo list of current epoch,
+// list still holding memory of older epoch is returned first
+void
+EpochReclaimer::Retire( void* address )
+{
+	ThreadRecord* record = GetThreadRecord();
+
+	// memory was unlinked before this load
+	uint64_t epoch = m_globalEpoch.load( std::memory_order_seq_cst );
+	size_t index = epoch % 3;
+
+	// list of this slot is at least three epochs old
+	if(record->limboEpoch[index] != epoch)
+	{
+		record->nrOfRetired -= ReturnBlocks( record->limbo[index] );
+		record->limbo[index] = nullptr;
+		record->limboEpoch[index] = epoch;
+	}
+
+	RetiredBlock* block = ToRetiredBlock( address );
+	block->next = record->limbo[index];
+	record->limbo[index] = block;
+
+	record->nrOfRetired++;
+	m_nrOfRetired.fetch_add( 1, std::memory_order_relaxed );
+
+	if(record->nrOfRetired >= RECLAIM_THRESHOLD)
+	{
+		TryReclaim();
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Method advances epoch and returns memory that became safe
+void
+EpochReclaimer::TryReclaim(void)
+{
+	TryAdvanceEpoch();
+
+	ThreadRecord* record = GetThreadRecord();
+	ReclaimRecord( record, m_globalEpoch.load( std::memory_order_acquire ) );
+}
+///////////////////////////////////////////////////////////
+
+// Method gives up calling thread record
+void
+EpochReclaimer::UnregisterThread(void)
+{
+	if(t_cachedReclaimerId != m_reclaimerId)
+	{
+		return;
+	}
+
+	ThreadRecord* record = reinterpret_cast<ThreadRecord*>(t_cachedRecord);
+
+	assert( record->guardDepth == 0 && "Thread unregistered while inside a Guard" );
+
+	ReclaimRecord( record, m_globalEpoch.load( std::memory_order_acquire ) );
+
+	record->owner.store( std::thread::id(), std::memory_order_relaxed );
+	record->isInUse.store( false, std::memory_order_release );
+
+	t_cachedReclaimerId = 0;
+	t_cachedRecord = nullptr;
+}
+///////////////////////////////////////////////////////////
+
+
+/******************* Internal Methods *********************/
+
+// internal method finds or creates record of calling thread,
+// free records of unregistered threads are reused
+EpochReclaimer::ThreadRecord*
+EpochReclaimer::GetThreadRecord(void)
+{
+	if(t_cachedReclaimerId == m_reclaimerId)
+	{
+		return reinterpret_cast<ThreadRecord*>(t_cachedRecord);
+	}
+
+	ThreadRecord* record = m_records.load( std::memory_order_acquire );
+	std::thread::id threadId = std::this_thread::get_id();
+
+	// record of this thread may exist if cache was used by another reclaimer
+	while(record != nullptr && record->owner.load( std::memory_order_relaxed ) != threadId)
+	{
+		record = record->next;
+	}
+
+	if(record == nullptr)
+	{
+		for(record = m_records.load( std::memory_order_acquire ); record != nullptr; record = record->next)
+		{
+			bool expected = false;
+			if(record->isInUse.load( std::memory_order_relaxed ) == false &&
+			   record->isInUse.compare_exchange_strong( expected, true, std::memory_order_acquire ))
+			{
+				record->owner.store( threadId, std::memory_order_relaxed );
+				break;
+			}
+		}
+	}
+
+	if(record == nullptr)
+	{
+		record = new ThreadRecord;
+		record->localEpoch.store( 0, std::memory_order_relaxed );
+		record->isInUse.store( true, std::memory_order_relaxed );
+		record->owner.store( threadId, std::memory_order_relaxed );
+		record->guardDepth = 0;
+		record->nrOfRetired = 0;
+
+		for(size_t i = 0; i < 3; i++)
+		{
+			record->limbo[i] = nullptr;
+			record->limboEpoch[i] = 0;
+		}
+
+		ThreadRecord* head = m_records.load( std::memory_order_relaxed );
+		do
+		{
+			record->next = head;
+		}
+		while(m_records.compare_exchange_weak( head, record, std::memory_order_release, std::memory_order_relaxed ) == false);
+	}
+
+	t_cachedReclaimerId = m_reclaimerId;
+	t_cachedRecord = record;
+
+	return record;
+}
+///////////////////////////////////////////////////////////
+
+// internal method advances global epoch if no active thread lags behind it
+bool
+EpochReclaimer::TryAdvanceEpoch(void)
+{
+	uint64_t epoch = m_globalEpoch.load( std::memory_order_seq_cst );
+
+	for(ThreadRecord* record = m_records.load( std::memory_order_acquire ); record != nullptr; record = record->next)
+	{
+		uint64_t localEpoch = record->localEpoch.load( std::memory_order_seq_cst );
+		if((localEpoch & 1) != 0 && (localEpoch >> 1) != epoch)
+		{
+			return false;
+		}
+	}
+
+	return m_globalEpoch.compare_exchange_strong( epoch, epoch + 1, std::memory_order_seq_cst );
+}
+///////////////////////////////////////////////////////////
+
+// internal method returns limbo lists retired two or more epochs ago
+void
+EpochReclaimer::ReclaimRecord( ThreadRecord* record, uint64_t globalEpoch )
+{
+	for(size_t i = 0; i < 3; i++)
+	{
+		if(record->limbo[i] != nullptr && record->limboEpoch[i] + 2 <= globalEpoch)
+		{
+			record->nrOfRetired -= ReturnBlocks( record->limbo[i] );
+			record->limbo[i] = nullptr;
+		}
+	}
+}
+///////////////////////////////////////////////////////////
+
+// internal method returns list of retired memory in one batch
+size_t
+EpochReclaimer::ReturnBlocks( RetiredBlock* block )
+{
+	size_t nrOfBlocks = 0;
+
+	while(block != nullptr)
+	{
+		RetiredBlock* next = block->next;
+		m_pool->Deallocate( ToAddress( block ) );
+		block = next;
+		nrOfBlocks++;
+	}
+
+	m_nrOfRetired.fetch_sub( nrOfBlocks, std::memory_order_relaxed );
+	return nrOfBlocks;
+}
+///////////////////////////////////////////////////////////
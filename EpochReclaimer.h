@@ -0,0 +1,154 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MemoryPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+
+//	Class:		EpochReclaimer
+//	Author:		Rafal Rebisz
+//	Purpose:	Defers returning memory into a pool until no thread
+//				can still be reading it, used by lock-free structures
+
+//	Use:		Instantiate passing pointer to pool memory is returned into and
+//				offset of pointer sized link field inside retired nodes. Readers
+//				access shared nodes only while holding a Guard, node removed from
+//				structure is passed to Retire instead of Deallocate. Thread that
+//				stops using the reclaimer calls UnregisterThread
+
+//	NOTE:		Global epoch advances once every thread inside a Guard has seen
+//				it, memory retired in epoch E is returned once global epoch reaches
+//				E + 2. Each thread keeps three limbo lists linked through retired
+//				memory itself, so retiring and reclaiming never allocate, only first
+//				use on a thread allocates its record. Link field is written while
+//				readers may still hold the node, so readers must never read it.
+//				Memory is returned by the thread that retired it,
+//				pool must be thread safe or be OwnedMemoryPool. Pool is not owned
+//				and must outlive the reclaimer
+
+class EpochReclaimer
+{
+public: // Constants
+
+	// retired blocks a thread collects before trying to reclaim
+	static const size_t RECLAIM_THRESHOLD = 64;
+
+private: // Structures
+
+	// limbo list node, stored in link field of retired memory
+	struct RetiredBlock
+	{
+		RetiredBlock* next;
+	};
+
+	// per thread state, records are never freed until reclaimer is destroyed
+	struct alignas(64) ThreadRecord
+	{
+		// (epoch << 1) | 1 while thread is inside a Guard, 0 otherwise
+		std::atomic<uint64_t> localEpoch;
+		// true while record is owned by a thread
+		std::atomic<bool> isInUse;
+		// thread owning the record, read by threads looking for their record
+		std::atomic<std::thread::id> owner;
+		// next record in reclaimer record list
+		ThreadRecord* next;
+
+		// fields below are used by owning thread only
+		size_t guardDepth;
+		RetiredBlock* limbo[3];
+		uint64_t limboEpoch[3];
+		size_t nrOfRetired;
+	};
+
+public: // Structures
+
+	// Marks calling thread as reading shared memory until end of scope
+	class Guard
+	{
+	public:
+		explicit Guard( EpochReclaimer& reclaimer ): m_reclaimer( reclaimer ) { m_reclaimer.Enter(); }
+		~Guard(void) { m_reclaimer.Leave(); }
+
+		Guard( const Guard& ) = delete;
+		Guard& operator=( const Guard& ) = delete;
+
+	private:
+		EpochReclaimer& m_reclaimer;
+	};
+
+public: // Methods
+
+	// Constructor
+	EpochReclaimer( MemoryPool* pool, size_t linkOffset = 0 );
+	// Destructor, returns all retired memory, no thread may be inside a Guard
+	~EpochReclaimer(void);
+
+	// Enter / Leave reading section, may be nested, Guard calls them
+	void Enter(void);
+	void Leave(void);
+
+	// Queues memory to be returned into pool once no reader can hold it
+	void Retire( void* address );
+
+	// Tries to advance global epoch and returns memory of calling thread that became safe
+	void TryReclaim(void);
+
+	// Releases calling thread record, memory it still holds is returned once
+	// safe by the thread that takes the record over or by the destructor
+	void UnregisterThread(void);
+
+	// Returns current global epoch
+	uint64_t GetEpoch(void) const { return m_globalEpoch.load( std::memory_order_acquire ); }
+
+	// Returns number of retired blocks not yet returned into pool
+	size_t GetNumberOfRetired(void) const { return m_nrOfRetired.load( std::memory_order_relaxed ); }
+
+	// Returns pool memory is returned into
+	MemoryPool* GetPool(void) const { return m_pool; }
+
+private: // internal methods
+
+	// Method returns record of calling thread, record is created on first use
+	ThreadRecord* GetThreadRecord(void);
+
+	// Method advances global epoch if every active thread has seen it
+	bool TryAdvanceEpoch(void);
+
+	// Method returns limbo lists of record that are at least two epochs old
+	void ReclaimRecord( ThreadRecord* record, uint64_t globalEpoch );
+
+	// Methods convert between retired memory and its link field
+	RetiredBlock* ToRetiredBlock( void* address ) const { return reinterpret_cast<RetiredBlock*>(reinterpret_cast<char*>(address) + m_linkOffset); }
+	void* ToAddress( RetiredBlock* block ) const { return reinterpret_cast<char*>(block) - m_linkOffset; }
+
+	// Method returns all memory on given limbo list into pool,
+	// returns number of blocks returned
+	size_t ReturnBlocks( RetiredBlock* block );
+
+private: // Members
+
+	// pool retired memory is returned into
+	MemoryPool* m_pool;
+
+	// offset of link field in retired memory
+	size_t m_linkOffset;
+
+	// unique ID used to find cached thread record
+	uint64_t m_reclaimerId;
+
+	// global epoch, kept away from records that are written often
+	alignas(64) std::atomic<uint64_t> m_globalEpoch;
+
+	// list of thread records, records are only added
+	std::atomic<ThreadRecord*> m_records;
+
+	// number of retired blocks waiting in limbo lists
+	std::atomic<size_t> m_nrOfRetired;
+};
@@ -5,29 +5,66 @@
 
 #include "FixedAllocationSizePool.h"
 #include <assert.h>
+#include <cstring>
 
-FixedAllocationSizePool::FixedAllocationSizePool( void* memory, unsigned int nrOfBlocks, size_t blockSize, std::string poolID ):
+FixedAllocationSizePool::FixedAllocationSizePool( void* memory, size_t nrOfBlocks, size_t blockSize, std::string poolID, bool memoryIsZeroed, unsigned int layout ):
 	MemoryPool( memory, (nrOfBlocks*blockSize), poolID, "FixedAllocationSizePool" ),
-	m_blockSize( blockSize )
+	m_blockSize( blockSize ),
+	m_freeBlocks( nullptr ),
+	m_untouchedBlock( 0 ),
+	m_memoryIsZeroed( memoryIsZeroed ),
+	m_blocksPerSlab( 0 ),
+	m_slabSize( 0 ),
+	m_blockShift( 0 )
 {
 	assert( blockSize >= sizeof( AllocationBlock ) && "Memory pool does not support allocations smaller than 4 bytes" );
+	assert( nrOfBlocks <= ~(size_t)0 / blockSize && "Pool size does not fit in size_t" );
+	assert( (layout == DEFAULT_LAYOUT || (reinterpret_cast<uintptr_t>(memory) % CACHE_LINE_SIZE) == 0) && "Memory must be cache line aligned" );
 	
 	m_nrOfBlocks = nrOfBlocks;
 
-	// create first block
-	char* bytePtr = reinterpret_cast<char*>(m_poolMemory);
+	if((layout & PAD_TO_CACHE_LINE) != 0)
+	{
+		m_blockSize = ((blockSize + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+		m_nrOfBlocks = m_poolSize / m_blockSize;
+	}
 
-	m_freeBlocks = reinterpret_cast<AllocationBlock*>(bytePtr);
-	m_freeBlocks->nextFreeBlock = nullptr;
+	if((layout & COLOR_SLABS) != 0)
+	{
+		// slab ends at cache line and leaves room for largest color after its blocks
+		m_blocksPerSlab = (m_blockSize < SLAB_SIZE) ? (SLAB_SIZE / m_blockSize) : 1;
+		m_slabSize = (((m_blocksPerSlab * m_blockSize) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+		m_slabSize += (NR_OF_COLORS - 1) * CACHE_LINE_SIZE;
+
+		// last slab holds blocks that fit after its color
+		size_t nrOfSlabs = m_poolSize / m_slabSize;
+		size_t lastColor = (nrOfSlabs % NR_OF_COLORS) * CACHE_LINE_SIZE;
+		size_t remainder = m_poolSize - (nrOfSlabs * m_slabSize);
+		size_t lastBlocks = (remainder > lastColor) ? ((remainder - lastColor) / m_blockSize) : 0;
+
+		m_nrOfBlocks = (nrOfSlabs * m_blocksPerSlab) + ((lastBlocks < m_blocksPerSlab) ? lastBlocks : m_blocksPerSlab);
+	}
 
-	// create proceeding blocks omitting first one 
-	unsigned int i = 1;
-	for(i; i < nrOfBlocks; i++)
+	if((m_blockSize & (m_blockSize - 1)) == 0)
 	{
-		AllocationBlock* currentBlock = reinterpret_cast<AllocationBlock*>(bytePtr + (blockSize * i));
-		currentBlock->nextFreeBlock = m_freeBlocks;
-		m_freeBlocks = currentBlock;
+		while((size_t(1) << m_blockShift) < m_blockSize)
+		{
+			m_blockShift++;
+		}
 	}
+
+#ifdef POOL_HARDENED
+	m_hardeningKey = CreateHardeningKey( this );
+	m_verifyBlock = 0;
+	m_handedOutSize = 0;
+	m_blockMask = (m_blockShift != 0 && m_blocksPerSlab == 0) ? (m_blockSize - 1) : 0;
+#else
+	m_verifyCursor = nullptr;
+	m_verifyCount = 0;
+#endif
+
+	// blocks are not linked here, they are taken from untouched
+	// part of the pool until each of them was allocated once
 }
 /////////////////////////////////////////////////////
 
@@ -41,16 +78,67 @@ FixedAllocationSizePool::~FixedAllocationSizePool()
 // Method used to allocate memory and return it's address
 void*
 FixedAllocationSizePool::Allocate( size_t size )
+{
+	void* address = FixedAllocationSizePool::TryAllocate( size );
+
+	assert( address != nullptr && "No Free Memory" );
+	return address;
+}
+/////////////////////////////////////////////////////
+
+// Method used to allocate memory, returned blocks are reused first
+// than never used blocks are taken in address order
+void*
+FixedAllocationSizePool::TryAllocate( size_t size )
 {
 	assert( size <= m_blockSize && "Incorrect allocation size" );
-	assert( m_freeBlocks != nullptr && "No Free Memory" );
+	(void)size;
 
 	// store firs available block, this block is 
 	// going to be used to allocate memory
 	AllocationBlock* blockToAllocate = m_freeBlocks;
 
-	// update linked list
-	m_freeBlocks = m_freeBlocks->nextFreeBlock;
+	if(blockToAllocate != nullptr)
+	{
+#ifdef POOL_HARDENED
+		// head has to carry free tag, only pool key gives matching tag so head
+		// is known to be free block, its link is only checked to point into
+		// the pool here and tag of next block is checked once it becomes head.
+		// Block returned twice is on the list twice, its tag is cleared when it
+		// is taken first so it is caught before it can be handed out again
+		AllocationBlock* nextBlock = reinterpret_cast<AllocationBlock*>(EncodeLink( blockToAllocate->nextFreeBlock, blockToAllocate, m_hardeningKey ));
+		size_t nextOffset = (size_t)(reinterpret_cast<uintptr_t>(nextBlock) - reinterpret_cast<uintptr_t>(m_poolMemory));
+
+		if(IsBlockFree( blockToAllocate ) == false || (nextBlock != nullptr && nextOffset > m_poolSize - sizeof( AllocationBlock )))
+		{
+			ReportCorruption( "Double free or free list link corrupted", blockToAllocate );
+			return nullptr;
+		}
+
+		blockToAllocate->freeTag = 0;
+		m_freeBlocks = nextBlock;
+#else
+		// update linked list, VerifyHeap continues from next
+		// block when block it stopped at is taken
+		m_freeBlocks = m_freeBlocks->nextFreeBlock;
+		if(blockToAllocate == m_verifyCursor)
+		{
+			m_verifyCursor = m_freeBlocks;
+		}
+#endif
+	}
+	else if(m_untouchedBlock < m_nrOfBlocks)
+	{
+		blockToAllocate = GetBlockAddress( m_untouchedBlock );
+		m_untouchedBlock++;
+#ifdef POOL_HARDENED
+		m_handedOutSize += m_blockSize;
+#endif
+	}
+	else
+	{
+		return nullptr;
+	}
 
 	m_nrOfAllocations++;
 	m_totalAllocated += m_blockSize;
@@ -59,6 +147,34 @@ FixedAllocationSizePool::Allocate( size_t size )
 }
 /////////////////////////////////////////////////////
 
+// Method used to allocate zero filled memory
+void*
+FixedAllocationSizePool::AllocateZeroed( size_t size )
+{
+	void* address = TryAllocateZeroed( size );
+
+	assert( address != nullptr && "No Free Memory" );
+	return address;
+}
+/////////////////////////////////////////////////////
+
+// Method clears reused blocks, untouched blocks
+// are cleared only if memory was not zeroed
+void*
+FixedAllocationSizePool::TryAllocateZeroed( size_t size )
+{
+	bool isUntouched = (m_freeBlocks == nullptr);
+
+	void* address = FixedAllocationSizePool::TryAllocate( size );
+	if(address != nullptr && (isUntouched == false || m_memoryIsZeroed == false))
+	{
+		memset( address, 0, size );
+	}
+
+	return address;
+}
+/////////////////////////////////////////////////////
+
 // Method used to return memory into pool 
 void 
 FixedAllocationSizePool::Deallocate( void* address )
@@ -70,11 +186,181 @@ FixedAllocationSizePool::Deallocate( void* address )
 	// Create block at returned address
 	AllocationBlock* returnedBlock = reinterpret_cast<AllocationBlock*>(address);
 
+#ifdef POOL_HARDENED
+	// block is returned only if it starts handed out block, blocks of power of two
+	// size that are not colored are checked with mask, block is not read so free
+	// of block that is not in cache does not wait for it, double free is caught
+	// when block is taken from free list for the second time
+	size_t offset = (size_t)(reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(m_poolMemory));
+	bool isBlockStart = (m_blockMask != 0) ? (offset < m_handedOutSize && (offset & m_blockMask) == 0) : (GetBlockIndex( address ) != m_nrOfBlocks);
+
+	if(isBlockStart == false)
+	{
+		ReportCorruption( "Address was not allocated from pool", address );
+		return;
+	}
+
+	// insert returned block into free blocks list
+	returnedBlock->nextFreeBlock = reinterpret_cast<AllocationBlock*>(EncodeLink( m_freeBlocks, returnedBlock, m_hardeningKey ));
+	returnedBlock->freeTag = GetFreeTag( returnedBlock );
+#else
 	// insert returned block into free blocks list
 	returnedBlock->nextFreeBlock = m_freeBlocks;
+#endif
 	m_freeBlocks = returnedBlock;
 
 	m_nrOfAllocations--;
 	m_totalAllocated -= m_blockSize;
 }
-/////////////////////////////////////////////////////
\ No newline at end of file
+/////////////////////////////////////////////////////
+
+// Sized Deallocate, all blocks have the same size
+// so size is only verified in debug mode
+void
+FixedAllocationSizePool::Deallocate( void* address, size_t size )
+{
+#ifdef _DEBUG
+	assert( size <= m_blockSize && "Size does not match allocation" );
+#endif
+	(void)size;
+
+	Deallocate( address );
+}
+/////////////////////////////////////////////////////
+
+// Method checks free block links, in hardened mode free blocks are found from
+// their tags, else free list is walked from its head. List only changes at its
+// head so block walk stopped at stays in the list until it is allocated, then
+// walk continues from block that followed it. Blocks returned during the pass
+// are checked by next pass
+bool
+FixedAllocationSizePool::VerifyHeap( size_t maxBlocks )
+{
+#ifdef POOL_HARDENED
+	size_t lastBlock = (maxBlocks < m_untouchedBlock - m_verifyBlock) ? m_verifyBlock + maxBlocks : m_untouchedBlock;
+
+	for(; m_verifyBlock < lastBlock; m_verifyBlock++)
+	{
+		AllocationBlock* block = GetBlockAddress( m_verifyBlock );
+		if(IsBlockFree( block ) == false)
+		{
+			continue;
+		}
+
+		AllocationBlock* nextBlock = reinterpret_cast<AllocationBlock*>(EncodeLink( block->nextFreeBlock, block, m_hardeningKey ));
+
+		if(nextBlock != nullptr && (GetBlockIndex( nextBlock ) == m_nrOfBlocks || IsBlockFree( nextBlock ) == false))
+		{
+			m_verifyBlock = 0;
+			ReportCorruption( "Free list link corrupted", block );
+			return true;
+		}
+
+		// block returned twice in a row links to itself
+		if(nextBlock == block)
+		{
+			m_verifyBlock = 0;
+			ReportCorruption( "Double free", block );
+			return true;
+		}
+	}
+
+	if(m_verifyBlock >= m_untouchedBlock)
+	{
+		m_verifyBlock = 0;
+		return true;
+	}
+
+	return false;
+#else
+	if(m_verifyCursor == nullptr)
+	{
+		m_verifyCursor = m_freeBlocks;
+		m_verifyCount = 0;
+	}
+
+	for(size_t i = 0; i < maxBlocks && m_verifyCursor != nullptr; i++)
+	{
+		// pass only moves along blocks that were on the list when it started,
+		// visiting more blocks than were ever handed out means list has a loop
+		AllocationBlock* block = m_verifyCursor;
+		const char* problem = nullptr;
+
+		if(GetBlockIndex( block ) == m_nrOfBlocks)
+		{
+			problem = "Free list link corrupted";
+		}
+		else if(block->nextFreeBlock == block || ++m_verifyCount > m_untouchedBlock)
+		{
+			problem = "Double free or free list loop";
+		}
+
+		if(problem != nullptr)
+		{
+			m_verifyCursor = nullptr;
+			ReportCorruption( problem, block );
+			return true;
+		}
+
+		m_verifyCursor = block->nextFreeBlock;
+	}
+
+	return m_verifyCursor == nullptr;
+#endif
+}
+/////////////////////////////////////////////////////
+
+
+/******************* Internal Methods *********************/
+
+// internal method returns block address, colored slab
+// blocks start after color offset of their slab
+FixedAllocationSizePool::AllocationBlock*
+FixedAllocationSizePool::GetBlockAddress( size_t index ) const
+{
+	char* bytePtr = reinterpret_cast<char*>(m_poolMemory);
+
+	if(m_blocksPerSlab == 0)
+	{
+		return reinterpret_cast<AllocationBlock*>(bytePtr + (m_blockSize * index));
+	}
+
+	size_t slab = index / m_blocksPerSlab;
+	size_t slabStart = (slab * m_slabSize) + ((slab % NR_OF_COLORS) * CACHE_LINE_SIZE);
+
+	return reinterpret_cast<AllocationBlock*>(bytePtr + slabStart + ((index - (slab * m_blocksPerSlab)) * m_blockSize));
+}
+/////////////////////////////////////////////////////
+
+// internal method computes block index with shift when block size is power of two
+size_t
+FixedAllocationSizePool::GetBlockIndex( const void* address ) const
+{
+	size_t offset = (size_t)(reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(m_poolMemory));
+	size_t firstBlock = 0;
+
+	// offset in colored slab is taken from its first block, address
+	// in color space or past last block of slab wraps to large offset
+	if(m_blocksPerSlab != 0)
+	{
+		size_t slab = offset / m_slabSize;
+		offset -= (slab * m_slabSize) + ((slab % NR_OF_COLORS) * CACHE_LINE_SIZE);
+		if(offset >= m_blocksPerSlab * m_blockSize)
+		{
+			return m_nrOfBlocks;
+		}
+
+		firstBlock = slab * m_blocksPerSlab;
+	}
+
+	size_t index = (m_blockShift != 0) ? (offset >> m_blockShift) : (offset / m_blockSize);
+
+	// address below pool wraps to offset past untouched blocks
+	if((index * m_blockSize) != offset || (firstBlock + index) >= m_untouchedBlock)
+	{
+		return m_nrOfBlocks;
+	}
+
+	return firstBlock + index;
+}
+/////////////////////////////////////////////////////
@@ -17,23 +17,82 @@ private:
 	struct AllocationBlock
 	{
 		AllocationBlock* nextFreeBlock;
+#ifdef POOL_HARDENED
+		// block address encoded with pool key while block is free
+		uintptr_t freeTag;
+#endif
+	};
+
+public: // Constants
+
+	// cache line size blocks are padded and colored with
+	static const size_t CACHE_LINE_SIZE = 64;
+	// size of colored slab without its color space
+	static const size_t SLAB_SIZE = 4096;
+	// number of cache line offsets colored slabs start at
+	static const size_t NR_OF_COLORS = 8;
+
+	// Block layout options, options can be combined. Pool keeps its memory
+	// size, blocks that do not fit with selected layout are not used
+	enum Layout
+	{
+		DEFAULT_LAYOUT = 0,
+		// block size is rounded up to multiple of cache line
+		// so blocks handed to different threads never share a line
+		PAD_TO_CACHE_LINE = 1,
+		// blocks are grouped into slabs, each slab starts at next of NR_OF_COLORS
+		// cache line offsets so same blocks of different slabs map to different cache sets
+		COLOR_SLABS = 2
 	};
 	
 public: // Methods
 
-	// Constructor
-	FixedAllocationSizePool(void* memory,unsigned int nrOfBlocks,size_t blockSize, std::string poolID);
+	// Constructor, memory must be cache line aligned if layout is not default
+	FixedAllocationSizePool(void* memory,size_t nrOfBlocks,size_t blockSize, std::string poolID, bool memoryIsZeroed = false, unsigned int layout = DEFAULT_LAYOUT);
 	// Destructor
 	virtual ~FixedAllocationSizePool();
 
 	// Methods used to allocate and free memory
 	virtual void* Allocate( size_t size );
 	virtual void Deallocate( void* address );
+	virtual void Deallocate( void* address, size_t size );
+
+	// Allocates block, returns nullptr if no free block is left
+	virtual void* TryAllocate( size_t size );
+
+	// Allocates zero filled block, blocks never used before are not
+	// cleared if pool memory was zeroed when pool was created
+	virtual void* AllocateZeroed( size_t size );
+	void* TryAllocateZeroed( size_t size );
 
 	// Returns block size in bytes
 	virtual size_t GetBlockSize() const { return m_blockSize; }
+
+	// Returns block size while any block is free
+	virtual size_t GetLargestFreeBlock() const { return (m_nrOfAllocations < m_nrOfBlocks) ? m_blockSize : 0; }
+
+	// Verifies links of at most maxBlocks free blocks continuing where previous
+	// call stopped, returns true once pass over all free blocks is finished
+	virtual bool VerifyHeap( size_t maxBlocks );
 	////////////////////////////////////////
 
+private: // internal methods
+
+	// Method returns address of block with given index
+	AllocationBlock* GetBlockAddress( size_t index ) const;
+
+	// Method returns index of handed out block starting at given address,
+	// m_nrOfBlocks if address is not start of block that was ever allocated
+	size_t GetBlockIndex( const void* address ) const;
+
+#ifdef POOL_HARDENED
+	// Method returns tag free block at given address carries
+	uintptr_t GetFreeTag( const AllocationBlock* block ) const { return ~(m_hardeningKey ^ reinterpret_cast<uintptr_t>(block)); }
+
+	// Method returns true if block carries free tag
+	bool IsBlockFree( const AllocationBlock* block ) const { return block->freeTag == GetFreeTag( block ); }
+#endif // if hardened
+
 private: // Data members
 
 	// stores block size in bytes
@@ -41,4 +100,40 @@ private: // Data members
 
 	// Singly linked list of avaliable blocks
 	AllocationBlock* m_freeBlocks;
+
+	// index of first block that has never been allocated, blocks past it
+	// are handed out in address order so their memory is not touched upfront
+	size_t m_untouchedBlock;
+
+	// true if untouched blocks are known to be zero
+	bool m_memoryIsZeroed;
+
+	// number of blocks in colored slab, 0 if slabs are not colored
+	size_t m_blocksPerSlab;
+
+	// distance between starts of colored slabs
+	size_t m_slabSize;
+
+	// log2 of block size if it is power of two, else 0
+	size_t m_blockShift;
+
+#ifdef POOL_HARDENED
+	// key free list links are encoded with
+	uintptr_t m_hardeningKey;
+
+	// index of block VerifyHeap continues from
+	size_t m_verifyBlock;
+
+	// size of memory in front of first untouched block
+	size_t m_handedOutSize;
+
+	// block size - 1 if blocks are found with mask, 0 if GetBlockIndex is used
+	size_t m_blockMask;
+#else
+	// free block VerifyHeap continues from, nullptr if no pass is in progress
+	AllocationBlock* m_verifyCursor;
+
+	// number of blocks visited by pass in progress
+	size_t m_verifyCount;
+#endif // if hardened
 };
\ No newline at end of file
@@ -0,0 +1,472 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//	File:		PoolMalloc.cpp
+//	Author:		Rafal Rebisz
+//	Purpose:	Replaces C allocation functions and global operator new / delete
+//				with SizeClassPool so unmodified programs can run on the pools
+
+//	Use:		Build as shared library together with pool sources, e.g.
+//				g++ -std=c++17 -O2 -fPIC -shared -I.. -o libpoolmalloc.so PoolMalloc.cpp
+//					../SizeClassPool.cpp ../FixedAllocationSizePool.cpp
+//					../DynamicAllocationSizePool.cpp ../MemoryPool.cpp -lpthread
+//				and run program with LD_PRELOAD=./libpoolmalloc.so
+
+//	NOTE:		Linux / glibc only. Pool memory is reserved lazily on first call,
+//				only touched pages are committed. Requests of LARGE_ALLOCATION bytes
+//				or more, requests pools cannot satisfy and alignments bigger than
+//				MAX_CLASS_SIZE are mapped directly. Allocations made while pool itself is
+//				being constructed are served from static bootstrap buffer and never
+//				freed. One lock guards the pool, it is held across fork. Must not be
+//				built with _DEBUG, allocation tracking would allocate under the lock
+
+#include "../SizeClassPool.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define POOL_MALLOC_EXPORT extern "C" __attribute__((visibility("default")))
+
+namespace
+{
+	// Pool layout constants
+	const size_t CLASS_REGION_SIZE = size_t(1) << 30;
+	const size_t POOL_SIZE = size_t(32) << 30;
+	const size_t LARGE_ALLOCATION = 256 * 1024;
+	const size_t BOOTSTRAP_SIZE = 64 * 1024;
+	const size_t SYSTEM_PAGE_SIZE = 4096;
+
+	// Header placed in front of directly mapped and bootstrap memory
+	struct ChunkHeader
+	{
+		size_t mappingSize;
+		size_t offset;
+	};
+
+	// Pool state
+	alignas(SizeClassPool) unsigned char g_poolStorage[sizeof( SizeClassPool )];
+	SizeClassPool* g_pool = nullptr;
+	char* g_poolBegin = nullptr;
+	char* g_poolEnd = nullptr;
+
+	// 0 - not initialized, 1 - initialized, fork handlers not registered, 2 - ready
+	std::atomic<int> g_state( 0 );
+	std::mutex g_lock;
+
+	// Bootstrap buffer
+	alignas(16) char g_bootstrap[BOOTSTRAP_SIZE];
+	std::atomic<size_t> g_bootstrapUsed( 0 );
+
+	// set while calling thread constructs the pool
+	__thread bool t_inInitialization __attribute__((tls_model("initial-exec"))) = false;
+
+	//********************************************************//
+
+	// Returns true if address is in bootstrap buffer
+	bool IsBootstrapAddress( void* address )
+	{
+		char* bytePtr = reinterpret_cast<char*>(address);
+		return bytePtr >= g_bootstrap && bytePtr < g_bootstrap + BOOTSTRAP_SIZE;
+	}
+	//////////////////////////////////////////////////////
+
+	// Returns true if address is in pool memory
+	bool IsPoolAddress( void* address )
+	{
+		char* bytePtr = reinterpret_cast<char*>(address);
+		return bytePtr >= g_poolBegin && bytePtr < g_poolEnd;
+	}
+	//////////////////////////////////////////////////////
+
+	// Allocates from bootstrap buffer, memory is never reused
+	void* BootstrapAllocate( size_t size )
+	{
+		if(size > BOOTSTRAP_SIZE)
+		{
+			return nullptr;
+		}
+
+		size_t total = sizeof( ChunkHeader ) + ((size + 15) & ~(size_t)15);
+		size_t offset = g_bootstrapUsed.fetch_add( total, std::memory_order_relaxed );
+
+		if(offset + total > BOOTSTRAP_SIZE)
+		{
+			return nullptr;
+		}
+
+		ChunkHeader* header = reinterpret_cast<ChunkHeader*>(g_bootstrap + offset);
+		header->mappingSize = total - sizeof( ChunkHeader );
+		header->offset = 0;
+
+		return header + 1;
+	}
+	//////////////////////////////////////////////////////
+
+	// Maps memory directly, header in front of returned address
+	// stores mapping size and distance from mapping start
+	void* LargeAllocate( size_t size, size_t alignment )
+	{
+		if(alignment < sizeof( ChunkHeader ))
+		{
+			alignment = sizeof( ChunkHeader );
+		}
+
+		size_t offset = (alignment > SYSTEM_PAGE_SIZE) ? alignment : ((sizeof( ChunkHeader ) + alignment - 1) / alignment) * alignment;
+		if(size > ~(size_t)0 - offset - (2 * SYSTEM_PAGE_SIZE))
+		{
+			return nullptr;
+		}
+
+		size_t mappingSize = (offset + size + SYSTEM_PAGE_SIZE - 1) & ~(SYSTEM_PAGE_SIZE - 1);
+
+		void* mapping = mmap( nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+		if(mapping == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+		// mapping is page aligned, bigger alignments are reached by moving
+		// the offset, mapping was made alignment bytes bigger to allow it
+		uintptr_t base = reinterpret_cast<uintptr_t>(mapping);
+		if(alignment > SYSTEM_PAGE_SIZE)
+		{
+			offset = ((base + sizeof( ChunkHeader ) + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+		}
+
+		ChunkHeader* header = reinterpret_cast<ChunkHeader*>(base + offset) - 1;
+		header->mappingSize = mappingSize;
+		header->offset = offset;
+
+		return header + 1;
+	}
+	//////////////////////////////////////////////////////
+
+	// Unmaps directly mapped memory
+	void LargeDeallocate( void* address )
+	{
+		ChunkHeader* header = reinterpret_cast<ChunkHeader*>(address) - 1;
+		munmap( reinterpret_cast<char*>(address) - header->offset, header->mappingSize );
+	}
+	//////////////////////////////////////////////////////
+
+	// Returns usable size of directly mapped or bootstrap memory
+	size_t ChunkSize( void* address )
+	{
+		ChunkHeader* header = reinterpret_cast<ChunkHeader*>(address) - 1;
+		return (header->offset == 0) ? header->mappingSize : (header->mappingSize - header->offset);
+	}
+	//////////////////////////////////////////////////////
+
+	// fork handlers keep the lock consistent in child process
+	void ForkPrepare(void) { g_lock.lock(); }
+	void ForkRelease(void) { g_lock.unlock(); }
+	//////////////////////////////////////////////////////
+
+	// Reserves pool memory and constructs the pool, allocations made
+	// by pool construction itself are served from bootstrap buffer
+	bool Initialize(void)
+	{
+		{
+			std::lock_guard<std::mutex> lock( g_lock );
+
+			if(g_state.load( std::memory_order_acquire ) == 0)
+			{
+				t_inInitialization = true;
+
+				void* memory = mmap( nullptr, POOL_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+				if(memory != MAP_FAILED)
+				{
+					g_pool = new (g_poolStorage) SizeClassPool( memory, POOL_SIZE, CLASS_REGION_SIZE, "pm", true );
+					g_poolBegin = reinterpret_cast<char*>(memory);
+					g_poolEnd = g_poolBegin + POOL_SIZE;
+					g_state.store( 1, std::memory_order_release );
+				}
+
+				t_inInitialization = false;
+			}
+		}
+
+		// registration may allocate, so it is done once the lock is released
+		int expected = 1;
+		if(g_state.compare_exchange_strong( expected, 2, std::memory_order_acq_rel ))
+		{
+			pthread_atfork( ForkPrepare, ForkRelease, ForkRelease );
+		}
+
+		return g_state.load( std::memory_order_acquire ) != 0;
+	}
+	//////////////////////////////////////////////////////
+
+	// Returns size pool is asked for, blocks of each
+	// class are aligned to class size
+	size_t RequestSize( size_t size, size_t alignment )
+	{
+		return (alignment > SizeClassPool::ALIGNMENT && size < alignment) ? alignment : size;
+	}
+	//////////////////////////////////////////////////////
+
+	// Allocates memory of at least given alignment, zeroed memory
+	// is requested from the pool, other sources are always zero
+	void* PoolAllocate( size_t size, size_t alignment, bool zeroed = false )
+	{
+		if(t_inInitialization)
+		{
+			return BootstrapAllocate( size );
+		}
+
+		if(size >= LARGE_ALLOCATION || alignment > SizeClassPool::MAX_CLASS_SIZE ||
+		   (g_state.load( std::memory_order_acquire ) == 0 && Initialize() == false))
+		{
+			return LargeAllocate( size, alignment );
+		}
+
+		void* address = nullptr;
+		{
+			std::lock_guard<std::mutex> lock( g_lock );
+			address = zeroed ? g_pool->TryAllocateZeroed( RequestSize( size, alignment ) ) : g_pool->TryAllocateAligned( RequestSize( size, alignment ), alignment );
+		}
+
+		return (address != nullptr) ? address : LargeAllocate( size, alignment );
+	}
+	//////////////////////////////////////////////////////
+
+	// Returns memory wherever it came from
+	void PoolDeallocate( void* address )
+	{
+		if(address == nullptr || IsBootstrapAddress( address ))
+		{
+			return;
+		}
+
+		if(IsPoolAddress( address ))
+		{
+			std::lock_guard<std::mutex> lock( g_lock );
+			g_pool->Deallocate( address );
+			return;
+		}
+
+		LargeDeallocate( address );
+	}
+	//////////////////////////////////////////////////////
+
+	// Returns memory allocated with given size and alignment, pool
+	// finds its size class from the size instead of the address
+	void PoolDeallocate( void* address, size_t size, size_t alignment )
+	{
+		if(address == nullptr || IsBootstrapAddress( address ))
+		{
+			return;
+		}
+
+		if(IsPoolAddress( address ))
+		{
+			std::lock_guard<std::mutex> lock( g_lock );
+			g_pool->Deallocate( address, RequestSize( size, alignment ) );
+			return;
+		}
+
+		LargeDeallocate( address );
+	}
+	//////////////////////////////////////////////////////
+
+	// Returns usable size of allocated memory
+	size_t PoolAllocationSize( void* address )
+	{
+		if(address == nullptr)
+		{
+			return 0;
+		}
+
+		if(IsPoolAddress( address ))
+		{
+			std::lock_guard<std::mutex> lock( g_lock );
+			return g_pool->GetAllocationSize( address );
+		}
+
+		return ChunkSize( address );
+	}
+	//////////////////////////////////////////////////////
+
+	// Allocation function used by operator new
+	void* OperatorNew( size_t size, size_t alignment )
+	{
+		void* address = PoolAllocate( size, alignment );
+		while(address == nullptr)
+		{
+			std::new_handler handler = std::get_new_handler();
+			if(handler == nullptr)
+			{
+				throw std::bad_alloc();
+			}
+			handler();
+			address = PoolAllocate( size, alignment );
+		}
+		return address;
+	}
+	//////////////////////////////////////////////////////
+
+	// Returns true if alignment is a power of two
+	bool IsPowerOfTwo( size_t value )
+	{
+		return value != 0 && (value & (value - 1)) == 0;
+	}
+	//////////////////////////////////////////////////////
+}
+
+
+/****************** C allocation functions ******************/
+
+POOL_MALLOC_EXPORT void* malloc( size_t size )
+{
+	void* address = PoolAllocate( size, SizeClassPool::ALIGNMENT );
+	if(address == nullptr)
+	{
+		errno = ENOMEM;
+	}
+	return address;
+}
+
+POOL_MALLOC_EXPORT void free( void* address )
+{
+	PoolDeallocate( address );
+}
+
+POOL_MALLOC_EXPORT void* calloc( size_t count, size_t size )
+{
+	if(size != 0 && count > ~(size_t)0 / size)
+	{
+		errno = ENOMEM;
+		return nullptr;
+	}
+
+	void* address = PoolAllocate( count * size, SizeClassPool::ALIGNMENT, true );
+	if(address == nullptr)
+	{
+		errno = ENOMEM;
+	}
+	return address;
+}
+
+POOL_MALLOC_EXPORT void* realloc( void* address, size_t size )
+{
+	if(address == nullptr)
+	{
+		return malloc( size );
+	}
+
+	if(size == 0)
+	{
+		free( address );
+		return nullptr;
+	}
+
+	size_t oldSize = IsBootstrapAddress( address ) ? ChunkSize( address ) : PoolAllocationSize( address );
+	if(size <= oldSize)
+	{
+		return address;
+	}
+
+	void* newAddress = malloc( size );
+	if(newAddress != nullptr)
+	{
+		memcpy( newAddress, address, oldSize );
+		free( address );
+	}
+	return newAddress;
+}
+
+POOL_MALLOC_EXPORT int posix_memalign( void** result, size_t alignment, size_t size )
+{
+	if(IsPowerOfTwo( alignment ) == false || (alignment % sizeof( void* )) != 0)
+	{
+		return EINVAL;
+	}
+
+	void* address = PoolAllocate( size, alignment );
+	if(address == nullptr)
+	{
+		return ENOMEM;
+	}
+
+	*result = address;
+	return 0;
+}
+
+POOL_MALLOC_EXPORT void* aligned_alloc( size_t alignment, size_t size )
+{
+	if(IsPowerOfTwo( alignment ) == false)
+	{
+		errno = EINVAL;
+		return nullptr;
+	}
+
+	void* address = PoolAllocate( size, alignment );
+	if(address == nullptr)
+	{
+		errno = ENOMEM;
+	}
+	return address;
+}
+
+POOL_MALLOC_EXPORT void* memalign( size_t alignment, size_t size )
+{
+	return aligned_alloc( alignment, size );
+}
+
+POOL_MALLOC_EXPORT void* valloc( size_t size )
+{
+	return aligned_alloc( SYSTEM_PAGE_SIZE, size );
+}
+
+POOL_MALLOC_EXPORT void* pvalloc( size_t size )
+{
+	if(size > ~(size_t)0 - (SYSTEM_PAGE_SIZE - 1))
+	{
+		errno = ENOMEM;
+		return nullptr;
+	}
+	return aligned_alloc( SYSTEM_PAGE_SIZE, (size + SYSTEM_PAGE_SIZE - 1) & ~(SYSTEM_PAGE_SIZE - 1) );
+}
+
+POOL_MALLOC_EXPORT size_t malloc_usable_size( void* address )
+{
+	if(address != nullptr && IsBootstrapAddress( address ))
+	{
+		return ChunkSize( address );
+	}
+	return PoolAllocationSize( address );
+}
+
+
+/****************** Global operator new / delete ******************/
+
+void* operator new( size_t size ) { return OperatorNew( size, SizeClassPool::ALIGNMENT ); }
+void* operator new[]( size_t size ) { return OperatorNew( size, SizeClassPool::ALIGNMENT ); }
+void* operator new( size_t size, const std::nothrow_t& ) noexcept { return PoolAllocate( size, SizeClassPool::ALIGNMENT ); }
+void* operator new[]( size_t size, const std::nothrow_t& ) noexcept { return PoolAllocate( size, SizeClassPool::ALIGNMENT ); }
+void* operator new( size_t size, std::align_val_t alignment ) { return OperatorNew( size, (size_t)alignment ); }
+void* operator new[]( size_t size, std::align_val_t alignment ) { return OperatorNew( size, (size_t)alignment ); }
+void* operator new( size_t size, std::align_val_t alignment, const std::nothrow_t& ) noexcept { return PoolAllocate( size, (size_t)alignment ); }
+void* operator new[]( size_t size, std::align_val_t alignment, const std::nothrow_t& ) noexcept { return PoolAllocate( size, (size_t)alignment ); }
+
+void operator delete( void* address ) noexcept { PoolDeallocate( address ); }
+void operator delete[]( void* address ) noexcept { PoolDeallocate( address ); }
+void operator delete( void* address, const std::nothrow_t& ) noexcept { PoolDeallocate( address ); }
+void operator delete[]( void* address, const std::nothrow_t& ) noexcept { PoolDeallocate( address ); }
+void operator delete( void* address, size_t size ) noexcept { PoolDeallocate( address, size, SizeClassPool::ALIGNMENT ); }
+void operator delete[]( void* address, size_t size ) noexcept { PoolDeallocate( address, size, SizeClassPool::ALIGNMENT ); }
+void operator delete( void* address, std::align_val_t ) noexcept { PoolDeallocate( address ); }
+void operator delete[]( void* address, std::align_val_t ) noexcept { PoolDeallocate( address ); }
+void operator delete( void* address, size_t size, std::align_val_t alignment ) noexcept { PoolDeallocate( address, size, (size_t)alignment ); }
+void operator delete[]( void* address, size_t size, std::align_val_t alignment ) noexcept { PoolDeallocate( address, size, (size_t)alignment ); }
+void operator delete( void* address, std::align_val_t, const std::nothrow_t& ) noexcept { PoolDeallocate( address ); }
+void operator delete[]( void* address, std::align_val_t, const std::nothrow_t& ) noexcept { PoolDeallocate( address ); }
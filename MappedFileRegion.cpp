@@ -0,0 +1,138 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "MappedFileRegion.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Constructor, creates file or maps existing one, file
+// that cannot be opened or has different size is not mapped
+MappedFileRegion::MappedFileRegion( std::string path, size_t size ):
+	m_path( path ),
+	m_address( nullptr ),
+	m_size( size ),
+	m_isCreator( false ),
+	m_fileHandle( nullptr ),
+	m_mappingHandle( nullptr )
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA( path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	m_fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx( file, &fileSize );
+	m_isCreator = (fileSize.QuadPart == 0);
+	if(m_isCreator == false && (size_t)fileSize.QuadPart != size)
+	{
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READWRITE,
+										 (DWORD)((unsigned long long)size >> 32), (DWORD)(size & 0xFFFFFFFF), nullptr );
+	if(mapping == nullptr)
+	{
+		return;
+	}
+	m_mappingHandle = mapping;
+
+	m_address = MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS, 0, 0, size );
+#else
+	int fd = open( path.c_str(), O_RDWR | O_CREAT, 0600 );
+	if(fd < 0)
+	{
+		return;
+	}
+
+	struct stat info;
+	if(fstat( fd, &info ) != 0)
+	{
+		close( fd );
+		return;
+	}
+
+	// empty file is treated as new one, file is extended
+	// without writing so its blocks are allocated lazily
+	if(info.st_size == 0)
+	{
+		m_isCreator = true;
+		if(ftruncate( fd, (off_t)size ) != 0)
+		{
+			close( fd );
+			return;
+		}
+	}
+	else if((size_t)info.st_size != size)
+	{
+		close( fd );
+		return;
+	}
+
+	void* address = mmap( nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+	close( fd );
+
+	m_address = (address == MAP_FAILED) ? nullptr : address;
+#endif
+}
+/////////////////////////////////////////////////////
+
+// Destructor
+MappedFileRegion::~MappedFileRegion(void)
+{
+	Flush();
+
+#ifdef _WIN32
+	if(m_address != nullptr)
+	{
+		UnmapViewOfFile( m_address );
+	}
+	if(m_mappingHandle != nullptr)
+	{
+		CloseHandle( reinterpret_cast<HANDLE>(m_mappingHandle) );
+	}
+	if(m_fileHandle != nullptr)
+	{
+		CloseHandle( reinterpret_cast<HANDLE>(m_fileHandle) );
+	}
+#else
+	if(m_address != nullptr)
+	{
+		munmap( m_address, m_size );
+	}
+#endif
+
+	m_address = nullptr;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+}
+/////////////////////////////////////////////////////
+
+// Method writes modified pages back to the file and waits for it
+void
+MappedFileRegion::Flush(void)
+{
+	if(m_address == nullptr)
+	{
+		return;
+	}
+
+#ifdef _WIN32
+	FlushViewOfFile( m_address, m_size );
+	FlushFileBuffers( reinterpret_cast<HANDLE>(m_fileHandle) );
+#else
+	msync( m_address, m_size, MS_SYNC );
+#endif
+}
+/////////////////////////////////////////////////////
@@ -0,0 +1,66 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <string>
+
+
+//	Class:		MappedFileRegion
+//	Author:		Rafal Rebisz
+//	Purpose:	Maps file into process address space so memory
+//				written into it survives process restart
+
+//	Use:		Instantiate passing file path and size, if file does not
+//				exist or is empty it is created with given size and IsCreator
+//				returns true, else existing file of the same size is mapped.
+//				GetAddress returns nullptr if file could not be mapped.
+//				Flush writes modified pages back to the file
+
+//	NOTE:		File may be mapped at different address after every restart,
+//				anything stored in it must not contain absolute pointers
+
+class MappedFileRegion
+{
+public:
+	// Constructor
+	MappedFileRegion( std::string path, size_t size );
+	// Destructor, flushes and unmaps the file
+	~MappedFileRegion(void);
+
+	// Returns address file is mapped at
+	void* GetAddress(void) const { return m_address; }
+
+	// Returns true if file is mapped
+	bool IsValid(void) const { return m_address != nullptr; }
+
+	// Returns mapped size
+	size_t GetSize(void) const { return m_size; }
+
+	// Returns file path
+	const std::string& GetPath(void) const { return m_path; }
+
+	// Returns true if file was created by this object
+	bool IsCreator(void) const { return m_isCreator; }
+
+	// Writes modified pages back to the file
+	void Flush(void);
+
+private:
+	// non copyable
+	MappedFileRegion( const MappedFileRegion& );
+	MappedFileRegion& operator=( const MappedFileRegion& );
+
+private:
+
+	std::string m_path;
+	void* m_address;
+	size_t m_size;
+	bool m_isCreator;
+
+	// file and mapping handles, only used on Windows
+	void* m_fileHandle;
+	void* m_mappingHandle;
+};
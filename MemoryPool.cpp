@@ -5,9 +5,70 @@
 
 #include "MemoryPool.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <assert.h>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Size of buffer corruption report is built in
+	const size_t REPORT_BUFFER_SIZE = 256;
+
+	// Appends text to report buffer, text not fitting is cut off
+	size_t AppendToReport( char* buffer, size_t length, const char* text )
+	{
+		while(*text != '\0' && length < REPORT_BUFFER_SIZE - 1)
+		{
+			buffer[length++] = *text++;
+		}
+		return length;
+	}
+
+	// Default corruption handler, pool state can not be trusted any more. Report is built
+	// in fixed buffer and written directly, stdio may allocate and pool may be the allocator
+	void AbortOnCorruption( const MemoryPool* pool, const char* message, const void* address )
+	{
+		char buffer[REPORT_BUFFER_SIZE];
+		size_t length = 0;
+
+		length = AppendToReport( buffer, length, "Memory pool " );
+		length = AppendToReport( buffer, length, pool->GetPoolID().c_str() );
+		length = AppendToReport( buffer, length, " corrupted: " );
+		length = AppendToReport( buffer, length, message );
+		length = AppendToReport( buffer, length, " at 0x" );
+
+		char digits[2 * sizeof( uintptr_t ) + 1];
+		uintptr_t value = reinterpret_cast<uintptr_t>(address);
+		for(size_t i = 0; i < 2 * sizeof( uintptr_t ); i++)
+		{
+			digits[i] = "0123456789abcdef"[(value >> (4 * (2 * sizeof( uintptr_t ) - 1 - i))) & 0xF];
+		}
+		digits[2 * sizeof( uintptr_t )] = '\0';
+
+		length = AppendToReport( buffer, length, digits );
+		length = AppendToReport( buffer, length, "\n" );
+
+#ifdef _WIN32
+		_write( 2, buffer, (unsigned int)length );
+#else
+		ssize_t written = write( 2, buffer, length );
+		(void)written;
+#endif
+		abort();
+	}
+
+	std::atomic<MemoryPool::CorruptionHandler> g_corruptionHandler( &AbortOnCorruption );
+}
+
 // Constructor
 MemoryPool::MemoryPool( void* memory, size_t size, std::string poolID, std::string poolType ):
 	m_poolMemory( memory ),
@@ -33,6 +94,63 @@ MemoryPool::~MemoryPool(void)
 }
 /////////////////////////////////////////////////////////////
 
+// Default sized Deallocate, size is not needed
+void
+MemoryPool::Deallocate( void* address, size_t size )
+{
+	(void)size;
+	Deallocate( address );
+}
+/////////////////////////////////////////////////////////////
+
+// Default zeroed allocation, whole request is cleared
+void*
+MemoryPool::AllocateZeroed( size_t size )
+{
+	void* address = Allocate( size );
+	memset( address, 0, size );
+	return address;
+}
+/////////////////////////////////////////////////////////////
+
+
+// Method replaces corruption handler of all pools
+MemoryPool::CorruptionHandler
+MemoryPool::SetCorruptionHandler( CorruptionHandler handler )
+{
+	return g_corruptionHandler.exchange( (handler != nullptr) ? handler : &AbortOnCorruption );
+}
+/////////////////////////////////////////////////////////////
+
+// Method calls current corruption handler
+void
+MemoryPool::ReportCorruption( const char* message, const void* address ) const
+{
+	g_corruptionHandler.load( std::memory_order_acquire )( this, message, address );
+}
+/////////////////////////////////////////////////////////////
+
+#ifdef POOL_HARDENED
+// Method mixes seed address, time and call counter into key,
+// key has low bits set so encoded nullptr is never nullptr
+uintptr_t
+MemoryPool::CreateHardeningKey( const void* seed )
+{
+	static std::atomic<uint64_t> counter( 0 );
+
+	uint64_t key = reinterpret_cast<uintptr_t>(seed) ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+	key += counter.fetch_add( 1, std::memory_order_relaxed ) * 0x9E3779B97F4A7C15ULL;
+
+	// splitmix64 finalizer
+	key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+	key = key ^ (key >> 31);
+
+	return (uintptr_t)key | 0xF;
+}
+/////////////////////////////////////////////////////////////
+#endif // if hardened
+
 
 // For Debug Use Only
 #ifdef _DEBUG
@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 
@@ -40,6 +41,18 @@ public:
 	virtual void* Allocate( size_t size ) = 0;
 	virtual void Deallocate( void* address ) = 0;
 
+	// Allocates memory, returns nullptr if request cannot be satisfied. Pools
+	// that can fail without asserting override it, others assert in Allocate
+	virtual void* TryAllocate( size_t size ) { return Allocate( size ); }
+
+	// Sized Deallocate, size must be the size memory was allocated with.
+	// Pools override it when size lets them skip reading block metadata
+	virtual void Deallocate( void* address, size_t size );
+
+	// Allocates memory with requested bytes set to zero. Pools
+	// that know which memory was never used override it
+	virtual void* AllocateZeroed( size_t size );
+
 	// Returns pool size
 	virtual size_t GetPoolSize( void ) const { return m_poolSize; }
 
@@ -53,13 +66,34 @@ public:
 	virtual void* GetMemoryPointer( void ) const { return m_poolMemory; }
 
 	// Returns number of currently allocated blocks
-	virtual unsigned int GetNumberOfAllocations( void ) const { return m_nrOfAllocations; }
+	virtual size_t GetNumberOfAllocations( void ) const { return m_nrOfAllocations; }
 
 	// Returns total size of allocations
 	virtual size_t GetTotalAllocated( void ) const { return m_totalAllocated; }
 
 	// Returns number of blocks in pool 
-	virtual unsigned int GetNumberOfBlocks() const { return m_nrOfBlocks; }
+	virtual size_t GetNumberOfBlocks() const { return m_nrOfBlocks; }
+
+	// Returns size of pool bookkeeping, 0 if pool does not track it
+	virtual size_t GetTotalOverhead( void ) const { return 0; }
+
+	// Returns size of largest free block, 0 if pool does not track it
+	virtual size_t GetLargestFreeBlock( void ) const { return 0; }
+
+	// Verifies at most maxBlocks blocks continuing where previous call stopped,
+	// corruption is passed to corruption handler. Returns true once pass over
+	// the whole pool is finished, pools without verifier finish straight away
+	virtual bool VerifyHeap( size_t maxBlocks ) { (void)maxBlocks; return true; }
+
+public: // Corruption handling
+
+	// Handler called when pool finds its metadata corrupted, if handler
+	// returns pool abandons operation that found the corruption
+	typedef void (*CorruptionHandler)( const MemoryPool* pool, const char* message, const void* address );
+
+	// Sets handler used by all pools, nullptr restores default handler
+	// witch prints message and aborts, returns previous handler
+	static CorruptionHandler SetCorruptionHandler( CorruptionHandler handler );
 
 public: // Methods used to track memory leaks
 
@@ -82,6 +116,23 @@ protected:// internal methods
 
 #endif // if not Debug
 
+protected:
+	// Method passes corruption found in this pool to corruption handler
+	void ReportCorruption( const char* message, const void* address ) const;
+
+#ifdef POOL_HARDENED
+	// Method returns random key used to encode free list links and canaries
+	static uintptr_t CreateHardeningKey( const void* seed );
+
+	// Method encodes free list link stored at given address, encoding link twice
+	// with the same key returns the link. Address and key are combined first so
+	// link only passes through one xor on its way into and out of free list
+	static void* EncodeLink( void* link, const void* storedAt, uintptr_t key )
+	{
+		return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(link) ^ (reinterpret_cast<uintptr_t>(storedAt) ^ key));
+	}
+#endif // if hardened
+
 
 protected: // Members
 
@@ -98,7 +149,7 @@ protected: // Members
 	std::string m_poolType;
 
 	// stores number of allocation
-	unsigned int m_nrOfAllocations;
+	size_t m_nrOfAllocations;
 
 
 
@@ -106,7 +157,7 @@ protected: // Members
 	size_t m_totalAllocated;
 
 	// stores number of blocks
-	unsigned int m_nrOfBlocks;
+	size_t m_nrOfBlocks;
 
 #ifdef _DEBUG
 	// Map Of Allocation information
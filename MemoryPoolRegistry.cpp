@@ -0,0 +1,427 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "MemoryPoolRegistry.h"
+
+#include <assert.h>
+
+// Constructor
+MemoryPoolRegistry::MemoryPoolRegistry(void):
+	m_root( new std::atomic<Leaf*>[ROOT_SIZE]() ),
+	m_retired( nullptr ),
+	m_retiredBeforeFlip( nullptr ),
+	m_phase( 0 )
+{
+	for(size_t i = 0; i < READER_STRIPES; i++)
+	{
+		m_readers[0][i].count.store( 0, std::memory_order_relaxed );
+		m_readers[1][i].count.store( 0, std::memory_order_relaxed );
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Destructor, no reader may be left, interior range of
+// pool is released in first granule pool fully covers
+MemoryPoolRegistry::~MemoryPoolRegistry(void)
+{
+	for(size_t i = 0; i < ROOT_SIZE; i++)
+	{
+		Leaf* leaf = m_root[i].load( std::memory_order_relaxed );
+		if(leaf == nullptr)
+		{
+			continue;
+		}
+
+		for(size_t j = 0; j < LEAF_SIZE; j++)
+		{
+			const PoolRange* chain = leaf->entries[j].load( std::memory_order_relaxed );
+			uintptr_t granule = (uintptr_t(i) << LEAF_BITS) | j;
+
+			if(chain != nullptr && IsFullyCovered( chain, granule ))
+			{
+				uintptr_t firstCovered = (chain->begin + (uintptr_t(1) << GRANULE_BITS) - 1) >> GRANULE_BITS;
+				if(firstCovered == granule)
+				{
+					delete chain;
+				}
+				continue;
+			}
+
+			while(chain != nullptr)
+			{
+				const PoolRange* next = chain->next;
+				delete chain;
+				chain = next;
+			}
+		}
+
+		delete leaf;
+	}
+	delete[] m_root;
+
+	for(RetiredRange* list : { m_retired, m_retiredBeforeFlip })
+	{
+		while(list != nullptr)
+		{
+			RetiredRange* next = list->next;
+			delete list->range;
+			delete list;
+			list = next;
+		}
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Method registers pool memory, every granule pool memory spans
+// is pointed at range describing the pool. Granules fully covered
+// by the pool share one range node, granules at pool edges may be
+// shared with neighbouring pools and get node chained in front of
+// the ranges already published there
+bool
+MemoryPoolRegistry::Register( MemoryPool* pool )
+{
+	assert( pool != nullptr && pool->GetPoolSize() > 0 && "Invalid pool" );
+
+	std::lock_guard<std::mutex> lock( m_writeLock );
+
+	uintptr_t begin = reinterpret_cast<uintptr_t>(pool->GetMemoryPointer());
+	uintptr_t end = begin + pool->GetPoolSize();
+
+	assert( ((end - 1) >> ADDRESS_BITS) == 0 && "Pool memory outside of supported address range" );
+
+	uintptr_t firstGranule = begin >> GRANULE_BITS;
+	uintptr_t lastGranule = (end - 1) >> GRANULE_BITS;
+
+	// every range published in granules pool spans is checked
+	// before anything is published, edge granules included
+	for(uintptr_t granule = firstGranule; granule <= lastGranule; granule++)
+	{
+		std::atomic<const PoolRange*>* entry = GetEntry( granule, false );
+		if(entry == nullptr)
+		{
+			continue;
+		}
+
+		for(const PoolRange* range = entry->load( std::memory_order_relaxed ); range != nullptr; range = range->next)
+		{
+			if(range->begin < end && begin < range->end)
+			{
+				return false;
+			}
+		}
+	}
+
+	const PoolRange* interior = nullptr;
+
+	for(uintptr_t granule = firstGranule; granule <= lastGranule; granule++)
+	{
+		std::atomic<const PoolRange*>* entry = GetEntry( granule, true );
+		const PoolRange* current = entry->load( std::memory_order_relaxed );
+
+		bool fullyCovered = ((granule << GRANULE_BITS) >= begin) &&
+							(((granule + 1) << GRANULE_BITS) <= end);
+
+		if(fullyCovered)
+		{
+			if(interior == nullptr)
+			{
+				interior = CreateRange( pool, begin, end, nullptr );
+			}
+			entry->store( interior, std::memory_order_release );
+		}
+		else
+		{
+			entry->store( CreateRange( pool, begin, end, current ), std::memory_order_release );
+		}
+	}
+
+	ReclaimRanges();
+	return true;
+}
+///////////////////////////////////////////////////////////
+
+// Method removes pool from every granule it was published in,
+// edge granules get a new chain that no longer contains the pool.
+// Unlinked nodes are retired, interior node only once
+void
+MemoryPoolRegistry::Unregister( MemoryPool* pool )
+{
+	std::lock_guard<std::mutex> lock( m_writeLock );
+
+	uintptr_t begin = reinterpret_cast<uintptr_t>(pool->GetMemoryPointer());
+	uintptr_t end = begin + pool->GetPoolSize();
+
+	uintptr_t firstGranule = begin >> GRANULE_BITS;
+	uintptr_t lastGranule = (end - 1) >> GRANULE_BITS;
+
+	const PoolRange* interior = nullptr;
+
+	for(uintptr_t granule = firstGranule; granule <= lastGranule; granule++)
+	{
+		std::atomic<const PoolRange*>* entry = GetEntry( granule, false );
+		if(entry == nullptr)
+		{
+			continue;
+		}
+
+		const PoolRange* current = entry->load( std::memory_order_relaxed );
+
+		bool isPublished = false;
+		for(const PoolRange* range = current; range != nullptr; range = range->next)
+		{
+			isPublished = isPublished || (range->pool == pool);
+		}
+
+		if(isPublished == false)
+		{
+			continue;
+		}
+
+		entry->store( CopyChainWithout( current, pool ), std::memory_order_release );
+
+		if(IsFullyCovered( current, granule ))
+		{
+			interior = current;
+		}
+		else
+		{
+			RetireChain( current );
+		}
+	}
+
+	if(interior != nullptr)
+	{
+		RetireChain( interior );
+	}
+
+	ReclaimRanges();
+}
+///////////////////////////////////////////////////////////
+
+// Method resolves owning pool, two dependent loads and
+// a short walk through ranges published for the granule
+MemoryPool*
+MemoryPoolRegistry::FindOwner( const void* address ) const
+{
+	uintptr_t value = reinterpret_cast<uintptr_t>(address);
+	if((value >> ADDRESS_BITS) != 0)
+	{
+		return nullptr;
+	}
+
+	uintptr_t granule = value >> GRANULE_BITS;
+
+	Leaf* leaf = m_root[granule >> LEAF_BITS].load( std::memory_order_acquire );
+	if(leaf == nullptr)
+	{
+		return nullptr;
+	}
+
+	// ranges are read only while reader is counted
+	std::atomic<size_t>& counter = EnterRead();
+	MemoryPool* owner = nullptr;
+
+	const PoolRange* range = leaf->entries[granule & (LEAF_SIZE - 1)].load( std::memory_order_acquire );
+	while(range != nullptr)
+	{
+		if(value >= range->begin && value < range->end)
+		{
+			owner = range->pool;
+			break;
+		}
+		range = range->next;
+	}
+
+	LeaveRead( counter );
+	return owner;
+}
+///////////////////////////////////////////////////////////
+
+// Method returns memory into its owning pool
+void
+MemoryPoolRegistry::Deallocate( void* address )
+{
+	MemoryPool* owner = FindOwner( address );
+	assert( owner != nullptr && "Memory wasn't allocated in any registered pool !" );
+
+	owner->Deallocate( address );
+}
+
+void
+MemoryPoolRegistry::Deallocate( void* address, size_t size )
+{
+	MemoryPool* owner = FindOwner( address );
+	assert( owner != nullptr && "Memory wasn't allocated in any registered pool !" );
+
+	owner->Deallocate( address, size );
+}
+///////////////////////////////////////////////////////////
+
+// Method returns global registry instance
+MemoryPoolRegistry&
+MemoryPoolRegistry::GetGlobalRegistry(void)
+{
+	static MemoryPoolRegistry registry;
+	return registry;
+}
+///////////////////////////////////////////////////////////
+
+
+/******************* Internal Methods *********************/
+
+// internal method used to get leaf entry of a granule, leaves are
+// created on demand by writers and are never released while registry lives
+std::atomic<const MemoryPoolRegistry::PoolRange*>*
+MemoryPoolRegistry::GetEntry( uintptr_t granule, bool create )
+{
+	std::atomic<Leaf*>& rootEntry = m_root[granule >> LEAF_BITS];
+	Leaf* leaf = rootEntry.load( std::memory_order_relaxed );
+
+	if(leaf == nullptr)
+	{
+		if(create == false)
+		{
+			return nullptr;
+		}
+
+		leaf = new Leaf();
+		rootEntry.store( leaf, std::memory_order_release );
+	}
+
+	return &leaf->entries[granule & (LEAF_SIZE - 1)];
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to create range node
+const MemoryPoolRegistry::PoolRange*
+MemoryPoolRegistry::CreateRange( MemoryPool* pool, uintptr_t begin, uintptr_t end, const PoolRange* next )
+{
+	PoolRange* range = new PoolRange;
+	range->pool = pool;
+	range->begin = begin;
+	range->end = end;
+	range->next = next;
+
+	return range;
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to remove pool from chain, chains are immutable
+// once published so the remaining ranges are copied into new nodes
+const MemoryPoolRegistry::PoolRange*
+MemoryPoolRegistry::CopyChainWithout( const PoolRange* chain, MemoryPool* pool )
+{
+	if(chain == nullptr)
+	{
+		return nullptr;
+	}
+
+	const PoolRange* rest = CopyChainWithout( chain->next, pool );
+	if(chain->pool == pool)
+	{
+		return rest;
+	}
+
+	return CreateRange( chain->pool, chain->begin, chain->end, rest );
+}
+///////////////////////////////////////////////////////////
+
+// internal method returns true if chain is interior range covering whole granule,
+// such chain holds single node as registered pools never overlap
+bool
+MemoryPoolRegistry::IsFullyCovered( const PoolRange* chain, uintptr_t granule )
+{
+	return chain->next == nullptr && (granule << GRANULE_BITS) >= chain->begin &&
+		   ((granule + 1) << GRANULE_BITS) <= chain->end;
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to queue every node of unpublished chain,
+// CopyChainWithout never reuses nodes so old chain is not shared
+void
+MemoryPoolRegistry::RetireChain( const PoolRange* chain )
+{
+	for(; chain != nullptr; chain = chain->next)
+	{
+		RetiredRange* retired = new RetiredRange;
+		retired->range = chain;
+		retired->next = m_retired;
+		m_retired = retired;
+	}
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to free retired ranges. Ranges retired before last
+// flip could only be read by readers counted in previous phase, once none
+// is left they are freed and ranges retired since are moved behind new flip.
+// Reader that counts itself in previous phase after the check sees new phase
+// when it checks phase again and retries without reading any range
+void
+MemoryPoolRegistry::ReclaimRanges(void)
+{
+	size_t previous = m_phase.load( std::memory_order_relaxed ) ^ 1;
+
+	for(size_t i = 0; i < READER_STRIPES; i++)
+	{
+		if(m_readers[previous][i].count.load( std::memory_order_seq_cst ) != 0)
+		{
+			return;
+		}
+	}
+
+	while(m_retiredBeforeFlip != nullptr)
+	{
+		RetiredRange* next = m_retiredBeforeFlip->next;
+		delete m_retiredBeforeFlip->range;
+		delete m_retiredBeforeFlip;
+		m_retiredBeforeFlip = next;
+	}
+
+	m_retiredBeforeFlip = m_retired;
+	m_retired = nullptr;
+
+	m_phase.store( previous, std::memory_order_seq_cst );
+}
+///////////////////////////////////////////////////////////
+
+// internal method counts reader in current phase, threads are
+// numbered in order they first read so they use different stripes
+std::atomic<size_t>&
+MemoryPoolRegistry::EnterRead(void) const
+{
+	static std::atomic<size_t> s_nextStripe( 0 );
+	static thread_local size_t t_stripe = s_nextStripe.fetch_add( 1, std::memory_order_relaxed ) % READER_STRIPES;
+
+	for(;;)
+	{
+		size_t phase = m_phase.load( std::memory_order_seq_cst );
+		std::atomic<size_t>& counter = m_readers[phase][t_stripe].count;
+		counter.fetch_add( 1, std::memory_order_seq_cst );
+
+		// writer may have flipped phase and checked counter before it was increased
+		if(m_phase.load( std::memory_order_seq_cst ) == phase)
+		{
+			return counter;
+		}
+
+		counter.fetch_sub( 1, std::memory_order_relaxed );
+	}
+}
+///////////////////////////////////////////////////////////
+
+
+// Global Free function, dispatches to the owning pool
+void
+Free( void* address )
+{
+	MemoryPoolRegistry::GetGlobalRegistry().Deallocate( address );
+}
+
+void
+Free( void* address, size_t size )
+{
+	MemoryPoolRegistry::GetGlobalRegistry().Deallocate( address, size );
+}
+///////////////////////////////////////////////////////////
@@ -0,0 +1,156 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MemoryPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+
+//	Class:		MemoryPoolRegistry
+//	Author:		Rafal Rebisz
+//	Purpose:	Maps any address to the pool whose memory it belongs to,
+//				so memory can be returned without knowing the owning pool
+
+//	Use:		Call Register passing in a constructed pool, Register fails if
+//				pool memory overlaps registered pool. After that FindOwner /
+//				Deallocate can be called with any address from that pool,
+//				call Unregister before the pool is destroyed.
+//				The global Free function uses the registry returned by
+//				MemoryPoolRegistry::GetGlobalRegistry()
+
+//	NOTE:		Lookups are lock-free and can run on any number of threads,
+//				Register / Unregister are serialized by an internal lock.
+//				Address space is split into granules of 64KB, a two-level
+//				radix table maps granule number to the pools covering it.
+//				Range nodes unlinked by writers are freed once no reader that
+//				entered before they were unlinked is left, readers count
+//				themselves in counters of current phase and writers flip the phase
+
+class MemoryPoolRegistry
+{
+private: // Structures
+
+	// Describes address range owned by one pool, granules shared
+	// by several pools (pool edges) hold a chain of ranges
+	struct PoolRange
+	{
+		MemoryPool* pool;
+		uintptr_t begin;
+		uintptr_t end;
+		const PoolRange* next;
+	};
+
+	// range unlinked by writer, waiting until readers cannot hold it
+	struct RetiredRange
+	{
+		const PoolRange* range;
+		RetiredRange* next;
+	};
+
+	// number of readers in one phase, readers are spread over
+	// stripes so threads do not write the same cache line
+	struct alignas(64) ReaderCount
+	{
+		std::atomic<size_t> count;
+	};
+	//********************************************************//
+
+	// Number of address bits resolved at each level
+	static const unsigned int GRANULE_BITS = 16;
+	static const unsigned int LEAF_BITS = 16;
+	static const unsigned int ADDRESS_BITS = (sizeof(void*) == 8) ? 48 : 32;
+	static const unsigned int ROOT_BITS = ADDRESS_BITS - GRANULE_BITS - LEAF_BITS;
+
+	static const size_t LEAF_SIZE = (size_t(1) << LEAF_BITS);
+	static const size_t ROOT_SIZE = (size_t(1) << ROOT_BITS);
+
+	// number of reader counters in each phase
+	static const size_t READER_STRIPES = 8;
+
+	// second level of radix table, one entry per granule
+	struct Leaf
+	{
+		std::atomic<const PoolRange*> entries[LEAF_SIZE];
+	};
+	//********************************************************//
+
+public: // Methods
+
+	// Constructor
+	MemoryPoolRegistry(void);
+	// Destructor
+	~MemoryPoolRegistry(void);
+
+	// Registers / unregisters pool memory, Register returns
+	// false if pool memory overlaps already registered pool
+	bool Register( MemoryPool* pool );
+	void Unregister( MemoryPool* pool );
+
+	// Returns pool that given address was allocated in
+	// or nullptr if address does not belong to any registered pool
+	MemoryPool* FindOwner( const void* address ) const;
+
+	// Returns memory into the pool it was allocated in
+	void Deallocate( void* address );
+	void Deallocate( void* address, size_t size );
+
+	// Returns registry used by the global Free function
+	static MemoryPoolRegistry& GetGlobalRegistry(void);
+
+private: // internal methods
+
+	// Method returns leaf entry for given granule, creates the leaf if requested
+	std::atomic<const PoolRange*>* GetEntry( uintptr_t granule, bool create );
+
+	// Method creates range node
+	const PoolRange* CreateRange( MemoryPool* pool, uintptr_t begin, uintptr_t end, const PoolRange* next );
+
+	// Method returns copy of given chain without ranges owned by pool
+	const PoolRange* CopyChainWithout( const PoolRange* chain, MemoryPool* pool );
+
+	// Method returns true if chain is interior range of pool covering whole granule
+	static bool IsFullyCovered( const PoolRange* chain, uintptr_t granule );
+
+	// Method queues every node of chain that is no longer published
+	void RetireChain( const PoolRange* chain );
+
+	// Method frees ranges retired before previous phase flip if no
+	// reader of previous phase is left, then flips the phase
+	void ReclaimRanges(void);
+
+	// Methods count reader in current phase, Enter returns counter to pass to Leave
+	std::atomic<size_t>& EnterRead(void) const;
+	void LeaveRead( std::atomic<size_t>& counter ) const { counter.fetch_sub( 1, std::memory_order_release ); }
+
+private: // Members
+
+	// first level of radix table
+	std::atomic<Leaf*>* m_root;
+
+	// ranges unlinked since last phase flip
+	RetiredRange* m_retired;
+
+	// ranges unlinked before last phase flip, freed after next flip
+	RetiredRange* m_retiredBeforeFlip;
+
+	// phase readers count themselves in, changed by writers only
+	std::atomic<size_t> m_phase;
+
+	// reader counters of both phases
+	mutable ReaderCount m_readers[2][READER_STRIPES];
+
+	// serializes writers
+	std::mutex m_writeLock;
+};
+
+
+// Returns memory into pool it was allocated in, pool
+// must be registered in the global registry
+void Free( void* address );
+void Free( void* address, size_t size );
@@ -0,0 +1,163 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "OwnedMemoryPool.h"
+
+#include <assert.h>
+
+// Constructor
+OwnedMemoryPool::OwnedMemoryPool( MemoryPool* pool, std::string poolID ):
+	MemoryPool( pool->GetMemoryPointer(), pool->GetPoolSize(), poolID, "OwnedMemoryPool" ),
+	m_pool( pool ),
+	m_ownerThread( std::this_thread::get_id() ),
+	m_remoteFrees( nullptr )
+{}
+/////////////////////////////////////////////////////
+
+// Destructor, any memory still queued is returned into the pool, destroying
+// thread is not checked as no other thread may use the pool any more
+OwnedMemoryPool::~OwnedMemoryPool(void)
+{
+	ReturnRemoteFrees();
+	m_pool = nullptr;
+}
+/////////////////////////////////////////////////////
+
+// Method used to allocate memory, queued remote frees
+// are returned into the pool first
+void*
+OwnedMemoryPool::Allocate( size_t size )
+{
+	assert( IsOwnerThread() && "Memory can only be allocated by owner thread" );
+
+	DrainRemoteFrees();
+
+	if(size < sizeof( RemoteBlock ))
+	{
+		size = sizeof( RemoteBlock );
+	}
+
+	return m_pool->Allocate( size );
+}
+///////////////////////////////////////////////////////////
+
+// Method allocates memory same way as Allocate,
+// wrapped pool returns nullptr instead of asserting
+void*
+OwnedMemoryPool::TryAllocate( size_t size )
+{
+	assert( IsOwnerThread() && "Memory can only be allocated by owner thread" );
+
+	DrainRemoteFrees();
+
+	if(size < sizeof( RemoteBlock ))
+	{
+		size = sizeof( RemoteBlock );
+	}
+
+	return m_pool->TryAllocate( size );
+}
+///////////////////////////////////////////////////////////
+
+// Method allocates zero filled memory from wrapped pool
+void*
+OwnedMemoryPool::AllocateZeroed( size_t size )
+{
+	assert( IsOwnerThread() && "Memory can only be allocated by owner thread" );
+
+	DrainRemoteFrees();
+
+	if(size < sizeof( RemoteBlock ))
+	{
+		size = sizeof( RemoteBlock );
+	}
+
+	return m_pool->AllocateZeroed( size );
+}
+/////////////////////////////////////////////////////
+
+// Method used to return memory, owner thread returns it straight into the pool
+// other threads push it onto remote free queue
+void
+OwnedMemoryPool::Deallocate( void* address )
+{
+	if(IsOwnerThread())
+	{
+		m_pool->Deallocate( address );
+		return;
+	}
+
+	RemoteBlock* block = reinterpret_cast<RemoteBlock*>(address);
+	RemoteBlock* head = m_remoteFrees.load( std::memory_order_relaxed );
+
+	do
+	{
+		block->next = head;
+	}
+	while(m_remoteFrees.compare_exchange_weak( head, block, std::memory_order_release, std::memory_order_relaxed ) == false);
+}
+///////////////////////////////////////////////////////////
+
+// Sized Deallocate, size is passed on when owner frees,
+// remote frees are queued without it
+void
+OwnedMemoryPool::Deallocate( void* address, size_t size )
+{
+	if(IsOwnerThread())
+	{
+		m_pool->Deallocate( address, size );
+		return;
+	}
+
+	Deallocate( address );
+}
+/////////////////////////////////////////////////////
+
+// Method takes whole remote free queue in one exchange and returns
+// every queued block into the pool, nodes are never popped one by one
+// so the queue does not suffer from ABA problem
+void
+OwnedMemoryPool::DrainRemoteFrees(void)
+{
+	// cheap check keeps owner fast path free of read-modify-write operations
+	if(m_remoteFrees.load( std::memory_order_relaxed ) == nullptr)
+	{
+		return;
+	}
+
+	assert( IsOwnerThread() && "Remote frees can only be drained by owner thread" );
+
+	ReturnRemoteFrees();
+}
+/////////////////////////////////////////////////////
+
+// Method verifies wrapped pool once remote frees are back in it
+bool
+OwnedMemoryPool::VerifyHeap( size_t maxBlocks )
+{
+	assert( IsOwnerThread() && "Pool can only be verified by owner thread" );
+
+	DrainRemoteFrees();
+
+	return m_pool->VerifyHeap( maxBlocks );
+}
+/////////////////////////////////////////////////////
+
+
+/******************* Internal Methods *********************/
+
+// internal method used to return queued memory without owner check
+void
+OwnedMemoryPool::ReturnRemoteFrees(void)
+{
+	RemoteBlock* block = m_remoteFrees.exchange( nullptr, std::memory_order_acquire );
+	while(block != nullptr)
+	{
+		RemoteBlock* next = block->next;
+		m_pool->Deallocate( block );
+		block = next;
+	}
+}
+/////////////////////////////////////////////////////
@@ -0,0 +1,97 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MemoryPool.h"
+
+#include <atomic>
+#include <thread>
+
+
+//	Class:		OwnedMemoryPool
+//	Author:		Rafal Rebisz
+//	Purpose:	Binds single threaded pool to an owner thread and lets
+//				any other thread return memory into it
+
+//	Use:		Instantiate on the owner thread passing in pointer to pool
+//				and ID, owner thread calls Allocate / Deallocate as usual,
+//				other threads may only call Deallocate. Memory returned by
+//				other threads is pushed onto lock-free remote free queue and
+//				returned into the pool in one batch on next owner Allocate
+
+//	NOTE:		Pool is not owned and must outlive this object, every allocation
+//				is at least sizeof(void*) bytes as queued memory is linked in place.
+//				Memory waiting on remote free queue is still counted as allocated
+//				and is not free for GetLargestFreeBlock until it is drained.
+//				Pool may be destroyed on any thread once no other thread uses it,
+//				e.g. by thread that joined the owner at shutdown
+
+class OwnedMemoryPool: public MemoryPool
+{
+private: // Structures
+
+	// remote free queue node, stored in returned memory
+	struct RemoteBlock
+	{
+		RemoteBlock* next;
+	};
+
+public: // Methods
+
+	// Constructor
+	OwnedMemoryPool( MemoryPool* pool, std::string poolID );
+	// Destructor, returns queued memory, may run on any thread
+	virtual ~OwnedMemoryPool(void);
+
+	// Methods used to allocate and free memory
+	virtual void* Allocate( size_t size );
+	virtual void Deallocate( void* address );
+	virtual void Deallocate( void* address, size_t size );
+	virtual void* AllocateZeroed( size_t size );
+
+	// Allocates memory, returns nullptr if wrapped pool cannot satisfy the request
+	virtual void* TryAllocate( size_t size );
+
+	// Returns memory queued by other threads into the pool, owner thread only
+	void DrainRemoteFrees(void);
+
+	// Makes calling thread the owner thread
+	void SetOwnerThread(void) { m_ownerThread = std::this_thread::get_id(); }
+
+	// Returns true if calling thread is the owner thread
+	bool IsOwnerThread(void) const { return std::this_thread::get_id() == m_ownerThread; }
+
+	// Returns pool that memory is allocated from
+	MemoryPool* GetPool(void) const { return m_pool; }
+
+	// Values are taken from underlying pool
+	virtual size_t GetNumberOfAllocations( void ) const { return m_pool->GetNumberOfAllocations(); }
+	virtual size_t GetTotalAllocated( void ) const { return m_pool->GetTotalAllocated(); }
+	virtual size_t GetNumberOfBlocks() const { return m_pool->GetNumberOfBlocks(); }
+	virtual size_t GetTotalOverhead( void ) const { return m_pool->GetTotalOverhead(); }
+	virtual size_t GetLargestFreeBlock( void ) const { return m_pool->GetLargestFreeBlock(); }
+
+	// Verifies wrapped pool, owner thread only, queued remote frees
+	// are returned first so their links are checked by the pass
+	virtual bool VerifyHeap( size_t maxBlocks );
+
+private: // internal methods
+
+	// Method returns every queued block into the pool, caller must be
+	// the only thread accessing the pool
+	void ReturnRemoteFrees(void);
+
+private: // Data members
+
+	// pool memory is allocated from
+	MemoryPool* m_pool;
+
+	// thread allowed to access the pool directly
+	std::thread::id m_ownerThread;
+
+	// multiple producer single consumer stack of memory returned by other threads
+	std::atomic<RemoteBlock*> m_remoteFrees;
+};
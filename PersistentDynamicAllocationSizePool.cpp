@@ -0,0 +1,48 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "PersistentDynamicAllocationSizePool.h"
+
+// Constructor, file created by mapped file region is formatted
+// existing file is attached to and optionally verified
+PersistentDynamicAllocationSizePool::PersistentDynamicAllocationSizePool( MappedFileRegion& file, std::string poolID, bool verifyOnOpen ):
+	SharedDynamicAllocationSizePool( file.GetAddress(), file.GetSize(), poolID, file.IsCreator(), false ),
+	m_file( file ),
+	m_wasRestored( file.IsCreator() == false ),
+	m_isConsistent( true )
+{
+	m_poolType = "PersistentDynamicAllocationSizePool";
+
+	if(m_wasRestored == false)
+	{
+		// magic written last marks formatting as complete, write it out
+		// so file is only seen as valid once it was fully formatted
+		m_file.Flush();
+		return;
+	}
+
+	// header did not match, file is foreign, corrupted or formatting
+	// was interrupted before magic was written
+	if(SharedDynamicAllocationSizePool::IsValid() == false)
+	{
+		return;
+	}
+
+	// lock may have been held when previous process stopped
+	ResetLock();
+
+	if(verifyOnOpen)
+	{
+		m_isConsistent = Verify();
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Destructor
+PersistentDynamicAllocationSizePool::~PersistentDynamicAllocationSizePool(void)
+{
+	m_file.Flush();
+}
+///////////////////////////////////////////////////////////
@@ -0,0 +1,60 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MappedFileRegion.h"
+#include "SharedDynamicAllocationSizePool.h"
+
+
+//	Class:		PersistentDynamicAllocationSizePool
+//	Author:		Rafal Rebisz
+//	Purpose:	Defines a memory pool from witch allocations of any size
+//				can be done, pool and everything allocated in it survives
+//				process restart
+
+//	Use:		Instantiate passing mapped file and ID, new file is formatted,
+//				existing file is reopened as it was left. Objects stored in the
+//				pool must link to each other with offsets (GetOffset / GetAddress),
+//				entry point is stored with SetRootOffset / GetRootOffset.
+//				IsValid must be checked before pool is used
+
+//	NOTE:		Pool state lives in the file in the same offset based form used by
+//				SharedDynamicAllocationSizePool, so reopening only checks the header
+//				(magic, version, layout checksum), nothing is rebuilt. When verifyOnOpen
+//				is set every block is also walked along physical links to make sure
+//				pool was not left inconsistent. Magic is written last and flushed, so
+//				file whose formatting was interrupted, foreign file or file failing
+//				the walk is reported by IsValid. File must only be used by one process
+
+class PersistentDynamicAllocationSizePool: public SharedDynamicAllocationSizePool
+{
+public: // Methods
+
+	// Constructor
+	PersistentDynamicAllocationSizePool( MappedFileRegion& file, std::string poolID, bool verifyOnOpen = true );
+	// Destructor, flushes pool state to the file
+	virtual ~PersistentDynamicAllocationSizePool(void);
+
+	// Writes pool state back to the file
+	void Flush(void) { m_file.Flush(); }
+
+	// Returns true if existing pool was reopened and not formatted
+	bool WasRestored(void) const { return m_wasRestored; }
+
+	// Returns true if header matched and pool passed verification on open
+	virtual bool IsValid(void) const { return SharedDynamicAllocationSizePool::IsValid() && m_isConsistent; }
+
+private: // Members
+
+	// file pool memory is mapped from
+	MappedFileRegion& m_file;
+
+	// true if pool was reopened
+	bool m_wasRestored;
+
+	// false if reopened pool failed verification
+	bool m_isConsistent;
+};
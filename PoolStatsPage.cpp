@@ -0,0 +1,258 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "PoolStatsPage.h"
+
+#include <assert.h>
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// number of times reader retries slot that is being written
+	const size_t READ_ATTEMPTS = 64;
+
+	// Writes string into atomic words, string is truncated or zero padded
+	void WriteName( std::atomic<uint64_t>* words, const std::string& name )
+	{
+		char buffer[PoolStatsPage::NAME_WORDS * 8] = {};
+		memcpy( buffer, name.c_str(), (name.size() < sizeof( buffer )) ? name.size() : sizeof( buffer ) );
+
+		for(size_t i = 0; i < PoolStatsPage::NAME_WORDS; i++)
+		{
+			uint64_t word;
+			memcpy( &word, buffer + (i * 8), 8 );
+			words[i].store( word, std::memory_order_relaxed );
+		}
+	}
+
+	// Reads atomic words back into zero terminated string
+	void ReadName( const std::atomic<uint64_t>* words, char* name )
+	{
+		for(size_t i = 0; i < PoolStatsPage::NAME_WORDS; i++)
+		{
+			uint64_t word = words[i].load( std::memory_order_relaxed );
+			memcpy( name + (i * 8), &word, 8 );
+		}
+		name[PoolStatsPage::NAME_WORDS * 8] = '\0';
+	}
+}
+
+// Constructor, page is formatted whether it was created or left by previous process
+PoolStatsPage::PoolStatsPage( std::string name ):
+	m_region( name, PAGE_SIZE ),
+	m_slots( GetSlots( m_region.GetAddress() ) )
+{
+	PageHeader* header = GetHeader( m_region.GetAddress() );
+
+	header->magic.store( 0, std::memory_order_relaxed );
+	header->version.store( VERSION, std::memory_order_relaxed );
+#ifdef _WIN32
+	header->processID.store( GetCurrentProcessId(), std::memory_order_relaxed );
+#else
+	header->processID.store( (uint64_t)getpid(), std::memory_order_relaxed );
+#endif
+	header->publishCount.store( 0, std::memory_order_relaxed );
+
+	for(size_t i = 0; i < MAX_POOLS; i++)
+	{
+		m_pools[i] = nullptr;
+		m_slots[i].sequence.store( 0, std::memory_order_relaxed );
+		m_slots[i].isInUse.store( 0, std::memory_order_relaxed );
+	}
+
+	// readers check magic before reading slots
+	header->magic.store( MAGIC, std::memory_order_release );
+}
+///////////////////////////////////////////////////////////
+
+// Destructor
+PoolStatsPage::~PoolStatsPage(void)
+{
+	GetHeader( m_region.GetAddress() )->magic.store( 0, std::memory_order_release );
+	SharedMemoryRegion::Remove( m_region.GetName() );
+}
+///////////////////////////////////////////////////////////
+
+// Method takes first unused slot for given pool
+bool
+PoolStatsPage::AddPool( MemoryPool* pool )
+{
+	assert( pool != nullptr && "Pool must be provided" );
+
+	for(size_t i = 0; i < MAX_POOLS; i++)
+	{
+		if(m_pools[i] == nullptr)
+		{
+			m_pools[i] = pool;
+			PublishSlot( i );
+			return true;
+		}
+	}
+
+	return false;
+}
+///////////////////////////////////////////////////////////
+
+// Method frees slot of given pool
+void
+PoolStatsPage::RemovePool( MemoryPool* pool )
+{
+	for(size_t i = 0; i < MAX_POOLS; i++)
+	{
+		if(m_pools[i] == pool)
+		{
+			PoolSlot& slot = m_slots[i];
+			uint64_t sequence = slot.sequence.load( std::memory_order_relaxed );
+
+			slot.sequence.store( sequence + 1, std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_release );
+			slot.isInUse.store( 0, std::memory_order_relaxed );
+			slot.sequence.store( sequence + 2, std::memory_order_release );
+
+			m_pools[i] = nullptr;
+			return;
+		}
+	}
+}
+///////////////////////////////////////////////////////////
+
+// Method publishes every added pool
+void
+PoolStatsPage::Publish(void)
+{
+	for(size_t i = 0; i < MAX_POOLS; i++)
+	{
+		if(m_pools[i] != nullptr)
+		{
+			PublishSlot( i );
+		}
+	}
+
+	GetHeader( m_region.GetAddress() )->publishCount.fetch_add( 1, std::memory_order_release );
+}
+///////////////////////////////////////////////////////////
+
+// Method copies slot, copy is used only if sequence did not change while copying
+bool
+PoolStatsPage::ReadPool( const void* page, size_t slotIndex, PoolStats& stats )
+{
+	assert( slotIndex < MAX_POOLS && "Incorrect slot" );
+
+	const PoolSlot& slot = GetSlots( page )[slotIndex];
+
+	for(size_t attempt = 0; attempt < READ_ATTEMPTS; attempt++)
+	{
+		uint64_t sequence = slot.sequence.load( std::memory_order_acquire );
+		if((sequence & 1) != 0)
+		{
+			continue;
+		}
+
+		bool isInUse = slot.isInUse.load( std::memory_order_relaxed ) != 0;
+		ReadName( slot.poolID, stats.poolID );
+		ReadName( slot.poolType, stats.poolType );
+		stats.poolSize = slot.poolSize.load( std::memory_order_relaxed );
+		stats.totalAllocated = slot.totalAllocated.load( std::memory_order_relaxed );
+		stats.totalOverhead = slot.totalOverhead.load( std::memory_order_relaxed );
+		stats.nrOfAllocations = slot.nrOfAllocations.load( std::memory_order_relaxed );
+		stats.nrOfBlocks = slot.nrOfBlocks.load( std::memory_order_relaxed );
+		stats.largestFreeBlock = slot.largestFreeBlock.load( std::memory_order_relaxed );
+		stats.publishTime = slot.publishTime.load( std::memory_order_relaxed );
+
+		// loads above must complete before sequence is checked again
+		std::atomic_thread_fence( std::memory_order_acquire );
+
+		if(slot.sequence.load( std::memory_order_relaxed ) == sequence)
+		{
+			return isInUse;
+		}
+	}
+
+	return false;
+}
+///////////////////////////////////////////////////////////
+
+// Method checks page magic and version
+bool
+PoolStatsPage::IsValidPage( const void* page )
+{
+	PageHeader* header = GetHeader( page );
+	return header->magic.load( std::memory_order_acquire ) == MAGIC &&
+		   header->version.load( std::memory_order_relaxed ) == VERSION;
+}
+///////////////////////////////////////////////////////////
+
+// Method returns publish counter of page
+uint64_t
+PoolStatsPage::GetPublishCount( const void* page )
+{
+	return GetHeader( page )->publishCount.load( std::memory_order_acquire );
+}
+///////////////////////////////////////////////////////////
+
+
+/******************* Internal Methods *********************/
+
+// internal methods return header and slots, slots start at 64 byte boundary
+PoolStatsPage::PageHeader*
+PoolStatsPage::GetHeader( const void* page )
+{
+	return reinterpret_cast<PageHeader*>(const_cast<void*>(page));
+}
+
+PoolStatsPage::PoolSlot*
+PoolStatsPage::GetSlots( const void* page )
+{
+	char* bytePtr = reinterpret_cast<char*>(const_cast<void*>(page));
+	return reinterpret_cast<PoolSlot*>(bytePtr + ((sizeof( PageHeader ) + 63) / 64) * 64);
+}
+///////////////////////////////////////////////////////////
+
+// internal method writes pool counters between two sequence increments
+void
+PoolStatsPage::PublishSlot( size_t slotIndex )
+{
+	MemoryPool* pool = m_pools[slotIndex];
+	PoolSlot& slot = m_slots[slotIndex];
+
+	// counters are read before slot is marked as being written
+	uint64_t poolSize = pool->GetPoolSize();
+	uint64_t totalAllocated = pool->GetTotalAllocated();
+	uint64_t totalOverhead = pool->GetTotalOverhead();
+	uint64_t nrOfAllocations = pool->GetNumberOfAllocations();
+	uint64_t nrOfBlocks = pool->GetNumberOfBlocks();
+	uint64_t largestFreeBlock = pool->GetLargestFreeBlock();
+	uint64_t publishTime = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::system_clock::now().time_since_epoch() ).count();
+
+	uint64_t sequence = slot.sequence.load( std::memory_order_relaxed );
+	slot.sequence.store( sequence + 1, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+
+	if(slot.isInUse.load( std::memory_order_relaxed ) == 0)
+	{
+		WriteName( slot.poolID, pool->GetPoolID() );
+		WriteName( slot.poolType, pool->GetPoolType() );
+		slot.isInUse.store( 1, std::memory_order_relaxed );
+	}
+
+	slot.poolSize.store( poolSize, std::memory_order_relaxed );
+	slot.totalAllocated.store( totalAllocated, std::memory_order_relaxed );
+	slot.totalOverhead.store( totalOverhead, std::memory_order_relaxed );
+	slot.nrOfAllocations.store( nrOfAllocations, std::memory_order_relaxed );
+	slot.nrOfBlocks.store( nrOfBlocks, std::memory_order_relaxed );
+	slot.largestFreeBlock.store( largestFreeBlock, std::memory_order_relaxed );
+	slot.publishTime.store( publishTime, std::memory_order_relaxed );
+
+	slot.sequence.store( sequence + 2, std::memory_order_release );
+}
+///////////////////////////////////////////////////////////
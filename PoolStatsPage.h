@@ -0,0 +1,134 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MemoryPool.h"
+#include "SharedMemoryRegion.h"
+
+#include <atomic>
+#include <cstdint>
+
+
+//	Class:		PoolStatsPage
+//	Author:		Rafal Rebisz
+//	Purpose:	Publishes pool counters into named shared memory
+//				page so other processes can watch them without locks
+
+//	Use:		Instantiate passing page name, add pools with AddPool and
+//				call Publish periodically (e.g. from a timer or between frames).
+//				Reader attaches read only SharedMemoryRegion of PAGE_SIZE bytes
+//				and calls ReadPool for each slot, see Tools/PoolTop.cpp
+
+//	NOTE:		Pools are only read when Publish is called, allocation path is
+//				not changed. Publish reads pool getters so it must be called from
+//				thread allowed to use the pool. Every slot is a seqlock: sequence is
+//				odd while slot is written, reader retries until it copies the slot
+//				between two equal even sequence values. All shared fields are atomic
+//				words so page may be read by any process at any time. Page name
+//				should be unique per process, page is reformatted on creation and
+//				removed by the destructor
+
+class PoolStatsPage
+{
+public: // Constants
+
+	static const uint64_t MAGIC = 0x5354415453504F4FULL;
+	static const uint32_t VERSION = 1;
+	static const size_t MAX_POOLS = 64;
+	static const size_t NAME_WORDS = 6;
+
+private: // Structures
+
+	// page header
+	struct PageHeader
+	{
+		std::atomic<uint64_t> magic;
+		std::atomic<uint64_t> version;
+		std::atomic<uint64_t> processID;
+		std::atomic<uint64_t> publishCount;
+	};
+
+	// published pool state, names are stored in words so they can be copied atomically
+	struct alignas(64) PoolSlot
+	{
+		std::atomic<uint64_t> sequence;
+		std::atomic<uint64_t> isInUse;
+		std::atomic<uint64_t> poolID[NAME_WORDS];
+		std::atomic<uint64_t> poolType[NAME_WORDS];
+		std::atomic<uint64_t> poolSize;
+		std::atomic<uint64_t> totalAllocated;
+		std::atomic<uint64_t> totalOverhead;
+		std::atomic<uint64_t> nrOfAllocations;
+		std::atomic<uint64_t> nrOfBlocks;
+		std::atomic<uint64_t> largestFreeBlock;
+		std::atomic<uint64_t> publishTime;
+	};
+
+public: // Structures
+
+	// Copy of one slot taken by reader
+	struct PoolStats
+	{
+		char poolID[NAME_WORDS * 8 + 1];
+		char poolType[NAME_WORDS * 8 + 1];
+		uint64_t poolSize;
+		uint64_t totalAllocated;
+		uint64_t totalOverhead;
+		uint64_t nrOfAllocations;
+		uint64_t nrOfBlocks;
+		uint64_t largestFreeBlock;
+		// nanoseconds since epoch of system clock
+		uint64_t publishTime;
+	};
+
+	// size of shared memory page
+	static const size_t PAGE_SIZE = ((sizeof( PageHeader ) + 63) / 64) * 64 + (sizeof( PoolSlot ) * MAX_POOLS);
+
+public: // Methods
+
+	// Constructor, creates and formats the page
+	PoolStatsPage( std::string name );
+	// Destructor, removes page name
+	~PoolStatsPage(void);
+
+	// Adds pool to the page, returns false if page is full
+	bool AddPool( MemoryPool* pool );
+	// Removes pool from the page
+	void RemovePool( MemoryPool* pool );
+
+	// Writes current counters of every added pool into the page
+	void Publish(void);
+
+	// Reads slot of page mapped by reader, returns false if slot is unused
+	// or was being written during every attempt
+	static bool ReadPool( const void* page, size_t slot, PoolStats& stats );
+
+	// Returns true if mapped page was formatted by a writer
+	static bool IsValidPage( const void* page );
+
+	// Returns number of times page was published, changes on every Publish
+	static uint64_t GetPublishCount( const void* page );
+
+private: // internal methods
+
+	// Methods return header and slots of page at given address
+	static PageHeader* GetHeader( const void* page );
+	static PoolSlot* GetSlots( const void* page );
+
+	// Method writes counters of one pool into its slot
+	void PublishSlot( size_t slot );
+
+private: // Members
+
+	// shared memory page
+	SharedMemoryRegion m_region;
+
+	// slots of the page
+	PoolSlot* m_slots;
+
+	// pools published in each slot, nullptr for unused slots
+	MemoryPool* m_pools[MAX_POOLS];
+};
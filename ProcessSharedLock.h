@@ -0,0 +1,104 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+
+// class: ProcessSharedLock	Author: Rafal Rebisz
+
+// Spin lock that can be placed in memory shared between processes,
+// lock-free atomics are address free so lock works no matter
+// at witch address each process maps the memory.
+// NOTE: lock is not robust, process dying while holding it
+// leaves it locked
+struct ProcessSharedLock
+{
+	static_assert( ATOMIC_INT_LOCK_FREE == 2, "Process shared lock requires lock-free atomics" );
+
+	// Sets lock to unlocked state, called by process formatting shared memory
+	void Initialize(void)
+	{
+		state.store( 0, std::memory_order_release );
+	}
+	//////////////////////////////////////////////////////
+
+	// Acquires lock, spins on plain load to keep cache line shared while waiting
+	void Lock(void)
+	{
+		while(state.exchange( 1, std::memory_order_acquire ) != 0)
+		{
+			while(state.load( std::memory_order_relaxed ) != 0)
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+	//////////////////////////////////////////////////////
+
+	// Releases lock
+	void Unlock(void)
+	{
+		state.store( 0, std::memory_order_release );
+	}
+	//////////////////////////////////////////////////////
+
+	std::atomic<uint32_t> state;
+};
+
+
+// class: ProcessSharedLockGuard	Author: Rafal Rebisz
+
+// Holds process shared lock for the lifetime of the object
+class ProcessSharedLockGuard
+{
+public:
+	explicit ProcessSharedLockGuard( ProcessSharedLock& lock ):
+		m_lock( lock )
+	{
+		m_lock.Lock();
+	}
+	//////////////////////////////////////////////////////
+
+	~ProcessSharedLockGuard(void)
+	{
+		m_lock.Unlock();
+	}
+	//////////////////////////////////////////////////////
+
+private:
+	ProcessSharedLockGuard( const ProcessSharedLockGuard& );
+	ProcessSharedLockGuard& operator=( const ProcessSharedLockGuard& );
+
+	ProcessSharedLock& m_lock;
+};
+
+
+// function: WaitForSharedFormat	Author: Rafal Rebisz
+
+// number of milliseconds process attaching to shared memory waits for formatting process
+static const size_t SHARED_ATTACH_ATTEMPTS = 1000;
+
+// Waits until process formatting shared memory stores expected magic, magic
+// is stored with release as last step of formatting so memory read after
+// this returns true is fully formatted. Returns false if magic did not
+// appear after given number of attempts spaced by a millisecond
+inline bool WaitForSharedFormat( const std::atomic<uint64_t>& magic, uint64_t expected, size_t attempts )
+{
+	for(size_t attempt = 0; magic.load( std::memory_order_acquire ) != expected; attempt++)
+	{
+		if(attempt >= attempts)
+		{
+			return false;
+		}
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+
+	return true;
+}
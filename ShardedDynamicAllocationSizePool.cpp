@@ -0,0 +1,30 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "ShardedDynamicAllocationSizePool.h"
+
+// Constructor, shards start at 16 byte boundaries
+ShardedDynamicAllocationSizePool::ShardedDynamicAllocationSizePool( void* memory, size_t poolSize, size_t nrOfShards, std::string poolID, bool deferCoalescing ):
+	ShardedMemoryPool( memory, poolSize, nrOfShards, 16, poolID, "ShardedDynamicAllocationSizePool" )
+{
+	for(size_t i = 0; i < nrOfShards; i++)
+	{
+		SetShardPool( i, new DynamicAllocationSizePool( GetShardMemory( i ), GetShardSize( i ), poolID + "_" + std::to_string( i ), deferCoalescing ) );
+	}
+}
+/////////////////////////////////////////////////////
+
+// Destructor, shard pools are deleted by ShardedMemoryPool
+ShardedDynamicAllocationSizePool::~ShardedDynamicAllocationSizePool(void)
+{}
+/////////////////////////////////////////////////////
+
+// Method allocates from shard without treating full shard as an error
+void*
+ShardedDynamicAllocationSizePool::TryAllocateFromShard( MemoryPool* pool, size_t size )
+{
+	return static_cast<DynamicAllocationSizePool*>(pool)->DynamicAllocationSizePool::TryAllocate( size );
+}
+/////////////////////////////////////////////////////
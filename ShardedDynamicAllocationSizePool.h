@@ -0,0 +1,37 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "DynamicAllocationSizePool.h"
+#include "ShardedMemoryPool.h"
+
+
+//	Class:		ShardedDynamicAllocationSizePool
+//	Author:		Rafal Rebisz
+//	Purpose:	Defines thread safe memory pool from witch allocations
+//				of any size can be done concurrently
+
+//	Use:		Instantiate passing pointer to preallocated memory, pool size,
+//				number of shards and ID into constructor, Allocate and
+//				Deallocate can be called from any thread
+
+//	NOTE:		Each shard is a DynamicAllocationSizePool starting at 16 byte
+//				boundary, sharding is done by ShardedMemoryPool
+
+class ShardedDynamicAllocationSizePool: public ShardedMemoryPool
+{
+public: // Methods
+
+	// Constructor
+	ShardedDynamicAllocationSizePool( void* memory, size_t poolSize, size_t nrOfShards, std::string poolID, bool deferCoalescing = false );
+	// Destructor
+	virtual ~ShardedDynamicAllocationSizePool(void);
+
+protected: // Methods used by ShardedMemoryPool
+
+	// Allocates from dynamic pool of shard
+	virtual void* TryAllocateFromShard( MemoryPool* pool, size_t size );
+};
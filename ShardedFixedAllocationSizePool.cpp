@@ -0,0 +1,36 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "ShardedFixedAllocationSizePool.h"
+
+#include <assert.h>
+
+// Constructor, shards start at cache line boundaries
+// so blocks of different shards never share a line
+ShardedFixedAllocationSizePool::ShardedFixedAllocationSizePool( void* memory, size_t poolSize, size_t blockSize, size_t nrOfShards, std::string poolID, unsigned int layout ):
+	ShardedMemoryPool( memory, poolSize, nrOfShards, FixedAllocationSizePool::CACHE_LINE_SIZE, poolID, "ShardedFixedAllocationSizePool" )
+{
+	assert( (reinterpret_cast<uintptr_t>(memory) % FixedAllocationSizePool::CACHE_LINE_SIZE) == 0 && "Memory must be cache line aligned" );
+	assert( GetShardSize( 0 ) >= blockSize && "Shard is to small to hold a block" );
+
+	for(size_t i = 0; i < nrOfShards; i++)
+	{
+		SetShardPool( i, new FixedAllocationSizePool( GetShardMemory( i ), GetShardSize( i ) / blockSize, blockSize, poolID + "_" + std::to_string( i ), false, layout ) );
+	}
+}
+/////////////////////////////////////////////////////
+
+// Destructor, shard pools are deleted by ShardedMemoryPool
+ShardedFixedAllocationSizePool::~ShardedFixedAllocationSizePool(void)
+{}
+/////////////////////////////////////////////////////
+
+// Method allocates block from shard without treating empty shard as an error
+void*
+ShardedFixedAllocationSizePool::TryAllocateFromShard( MemoryPool* pool, size_t size )
+{
+	return static_cast<FixedAllocationSizePool*>(pool)->FixedAllocationSizePool::TryAllocate( size );
+}
+/////////////////////////////////////////////////////
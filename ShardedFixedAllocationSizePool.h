@@ -0,0 +1,43 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "FixedAllocationSizePool.h"
+#include "ShardedMemoryPool.h"
+
+
+//	Class:		ShardedFixedAllocationSizePool
+//	Author:		Rafal Rebisz
+//	Purpose:	Defines thread safe fixed size memory pool where
+//				each thread is given blocks from its own slab of memory
+
+//	Use:		Instantiate passing pointer to preallocated memory, pool size,
+//				block size, number of shards and ID into constructor, Allocate
+//				and Deallocate can be called from any thread
+
+//	NOTE:		Each shard is a FixedAllocationSizePool with given layout starting
+//				at cache line boundary, so blocks sharing a cache line are used by
+//				the same thread while it allocates from its home shard. Sharding is
+//				done by ShardedMemoryPool. Memory must be cache line aligned
+
+class ShardedFixedAllocationSizePool: public ShardedMemoryPool
+{
+public: // Methods
+
+	// Constructor
+	ShardedFixedAllocationSizePool( void* memory, size_t poolSize, size_t blockSize, size_t nrOfShards, std::string poolID,
+									unsigned int layout = FixedAllocationSizePool::DEFAULT_LAYOUT );
+	// Destructor
+	virtual ~ShardedFixedAllocationSizePool(void);
+
+	// Returns block size of shards, padded if layout pads blocks
+	virtual size_t GetBlockSize() const { return static_cast<FixedAllocationSizePool*>(GetShardPool( 0 ))->GetBlockSize(); }
+
+protected: // Methods used by ShardedMemoryPool
+
+	// Allocates from fixed pool of shard
+	virtual void* TryAllocateFromShard( MemoryPool* pool, size_t size );
+};
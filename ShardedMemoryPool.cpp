@@ -0,0 +1,240 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "ShardedMemoryPool.h"
+
+#include <assert.h>
+#include <atomic>
+
+// Constructor, shard pools are created by deriving pool
+ShardedMemoryPool::ShardedMemoryPool( void* memory, size_t poolSize, size_t nrOfShards, size_t shardAlignment, std::string poolID, std::string poolType ):
+	MemoryPool( memory, poolSize, poolID, poolType ),
+	m_shards( nullptr ),
+	m_nrOfShards( nrOfShards ),
+	m_shardSize( 0 ),
+	m_verifyShard( 0 )
+{
+	assert( nrOfShards > 0 && "Pool must have at least one shard" );
+	assert( shardAlignment != 0 && (shardAlignment & (shardAlignment - 1)) == 0 && "Shard alignment must be power of two" );
+
+	m_shardSize = (poolSize / nrOfShards) & ~(shardAlignment - 1);
+	assert( m_shardSize > 0 && "Pool is to small to be split into shards" );
+
+	m_shards = new Shard[nrOfShards];
+	for(size_t i = 0; i < nrOfShards; i++)
+	{
+		m_shards[i].pool = nullptr;
+	}
+}
+/////////////////////////////////////////////////////
+
+// Destructor
+ShardedMemoryPool::~ShardedMemoryPool(void)
+{
+	for(size_t i = 0; i < m_nrOfShards; i++)
+	{
+		delete m_shards[i].pool;
+	}
+	delete[] m_shards;
+	m_shards = nullptr;
+}
+/////////////////////////////////////////////////////
+
+// Method used to allocate memory
+void*
+ShardedMemoryPool::Allocate( size_t size )
+{
+	void* address = ShardedMemoryPool::TryAllocate( size );
+
+	assert( address != nullptr && "No Free Memory Or Pool has become fragmented" );
+	return address;
+}
+/////////////////////////////////////////////////////
+
+// Method allocates memory from home shard of calling thread, if home
+// shard cannot satisfy the request remaining shards are tried in order
+void*
+ShardedMemoryPool::TryAllocate( size_t size )
+{
+	size_t home = GetHomeShard();
+
+	for(size_t i = 0; i < m_nrOfShards; i++)
+	{
+		Shard& shard = m_shards[(home + i) % m_nrOfShards];
+
+		void* address = nullptr;
+		{
+			std::lock_guard<std::mutex> lock( shard.lock );
+			address = TryAllocateFromShard( shard.pool, size );
+		}
+
+		if(address != nullptr)
+		{
+			return address;
+		}
+	}
+
+	return nullptr;
+}
+/////////////////////////////////////////////////////
+
+// Method returns memory into the shard it was allocated from
+void
+ShardedMemoryPool::Deallocate( void* address )
+{
+#ifdef _DEBUG
+	assert( CheckIfAllocatedHere( address ) == true && "Memory wasn't allocated in this pool !" );
+#endif
+
+	Shard& shard = m_shards[GetOwningShard( address )];
+
+	std::lock_guard<std::mutex> lock( shard.lock );
+	shard.pool->Deallocate( address );
+}
+
+void
+ShardedMemoryPool::Deallocate( void* address, size_t size )
+{
+#ifdef _DEBUG
+	assert( CheckIfAllocatedHere( address ) == true && "Memory wasn't allocated in this pool !" );
+#endif
+
+	Shard& shard = m_shards[GetOwningShard( address )];
+
+	std::lock_guard<std::mutex> lock( shard.lock );
+	shard.pool->Deallocate( address, size );
+}
+/////////////////////////////////////////////////////
+
+// Method returns number of allocations in all shards
+size_t
+ShardedMemoryPool::GetNumberOfAllocations( void ) const
+{
+	size_t total = 0;
+	for(size_t i = 0; i < m_nrOfShards; i++)
+	{
+		std::lock_guard<std::mutex> lock( m_shards[i].lock );
+		total += m_shards[i].pool->GetNumberOfAllocations();
+	}
+	return total;
+}
+/////////////////////////////////////////////////////
+
+// Method returns size allocated in all shards
+size_t
+ShardedMemoryPool::GetTotalAllocated( void ) const
+{
+	size_t total = 0;
+	for(size_t i = 0; i < m_nrOfShards; i++)
+	{
+		std::lock_guard<std::mutex> lock( m_shards[i].lock );
+		total += m_shards[i].pool->GetTotalAllocated();
+	}
+	return total;
+}
+/////////////////////////////////////////////////////
+
+// Method returns number of blocks in all shards
+size_t
+ShardedMemoryPool::GetNumberOfBlocks() const
+{
+	size_t total = 0;
+	for(size_t i = 0; i < m_nrOfShards; i++)
+	{
+		std::lock_guard<std::mutex> lock( m_shards[i].lock );
+		total += m_shards[i].pool->GetNumberOfBlocks();
+	}
+	return total;
+}
+/////////////////////////////////////////////////////
+
+// Method returns overhead of all shards
+size_t
+ShardedMemoryPool::GetTotalOverhead(void) const
+{
+	size_t total = 0;
+	for(size_t i = 0; i < m_nrOfShards; i++)
+	{
+		std::lock_guard<std::mutex> lock( m_shards[i].lock );
+		total += m_shards[i].pool->GetTotalOverhead();
+	}
+	return total;
+}
+
+size_t
+ShardedMemoryPool::GetLargestFreeBlock(void) const
+{
+	size_t largest = 0;
+	for(size_t i = 0; i < m_nrOfShards; i++)
+	{
+		std::lock_guard<std::mutex> lock( m_shards[i].lock );
+		size_t shardLargest = m_shards[i].pool->GetLargestFreeBlock();
+		largest = (shardLargest > largest) ? shardLargest : largest;
+	}
+	return largest;
+}
+/////////////////////////////////////////////////////
+
+// Method passes whole budget to shard being verified,
+// next shard is started once it finishes its pass
+bool
+ShardedMemoryPool::VerifyHeap( size_t maxBlocks )
+{
+	Shard& shard = m_shards[m_verifyShard];
+
+	{
+		std::lock_guard<std::mutex> lock( shard.lock );
+		if(shard.pool->VerifyHeap( maxBlocks ) == false)
+		{
+			return false;
+		}
+	}
+
+	m_verifyShard = (m_verifyShard + 1) % m_nrOfShards;
+	return m_verifyShard == 0;
+}
+/////////////////////////////////////////////////////
+
+// Method returns start of shard memory
+void*
+ShardedMemoryPool::GetShardMemory( size_t index ) const
+{
+	return reinterpret_cast<char*>(m_poolMemory) + (m_shardSize * index);
+}
+/////////////////////////////////////////////////////
+
+// Method returns shard size, last shard also owns remainder
+size_t
+ShardedMemoryPool::GetShardSize( size_t index ) const
+{
+	return (index == m_nrOfShards - 1) ? (m_poolSize - (m_shardSize * index)) : m_shardSize;
+}
+/////////////////////////////////////////////////////
+
+
+/******************* Internal Methods *********************/
+
+// internal method used to pick home shard, threads are numbered
+// in order they first allocate so consecutive threads get different shards
+size_t
+ShardedMemoryPool::GetHomeShard(void) const
+{
+	static std::atomic<size_t> s_nextThreadIndex( 0 );
+	static thread_local size_t t_threadIndex = s_nextThreadIndex.fetch_add( 1, std::memory_order_relaxed );
+
+	return t_threadIndex % m_nrOfShards;
+}
+/////////////////////////////////////////////////////
+
+// internal method used to find shard owning given address
+size_t
+ShardedMemoryPool::GetOwningShard( void* address ) const
+{
+	size_t offset = (size_t)(reinterpret_cast<char*>(address) - reinterpret_cast<char*>(m_poolMemory));
+	size_t index = offset / m_shardSize;
+
+	return (index < m_nrOfShards) ? index : (m_nrOfShards - 1);
+}
+/////////////////////////////////////////////////////
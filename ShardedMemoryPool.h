@@ -0,0 +1,108 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MemoryPool.h"
+
+#include <mutex>
+
+
+//	Class:		ShardedMemoryPool
+//	Author:		Rafal Rebisz
+//	Purpose:	Defines base of thread safe pools splitting
+//				their memory into shards guarded by own locks
+
+//	Use:		Derive passing shard alignment into constructor, create pool of
+//				every shard from GetShardMemory / GetShardSize, hand it over with
+//				SetShardPool and implement TryAllocateFromShard for its type
+
+//	NOTE:		Memory is split into equally sized shards, each a multiple of
+//				shard alignment in size, last shard also owns remainder. Every thread is
+//				given a home shard it allocates from, when home shard cannot satisfy
+//				the request other shards are tried. Deallocate finds owning shard from
+//				the address so memory always goes back where it came from. Shard pools
+//				are deleted with sharded pool
+
+class ShardedMemoryPool: public MemoryPool
+{
+private: // Structures
+
+	// shard is placed on its own cache line so
+	// locks of different shards do not share it
+	struct alignas(64) Shard
+	{
+		std::mutex lock;
+		MemoryPool* pool;
+	};
+
+public: // Methods
+
+	// Destructor, deletes shard pools
+	virtual ~ShardedMemoryPool(void);
+
+	// Methods used to allocate and free memory
+	virtual void* Allocate( size_t size );
+	virtual void Deallocate( void* address );
+	virtual void Deallocate( void* address, size_t size );
+
+	// Allocates memory, returns nullptr if no shard can satisfy the request
+	virtual void* TryAllocate( size_t size );
+
+	// Returns number of shards
+	size_t GetNumberOfShards(void) const { return m_nrOfShards; }
+
+	// Values are summed over all shards
+	virtual size_t GetNumberOfAllocations( void ) const;
+	virtual size_t GetTotalAllocated( void ) const;
+	virtual size_t GetNumberOfBlocks() const;
+	virtual size_t GetTotalOverhead(void) const;
+
+	// Returns largest free block of all shards
+	virtual size_t GetLargestFreeBlock(void) const;
+
+	// Verifies shards one after another holding lock of shard being
+	// verified, must not be called from several threads at once
+	virtual bool VerifyHeap( size_t maxBlocks );
+
+protected: // Methods used by deriving pools
+
+	// Constructor
+	ShardedMemoryPool( void* memory, size_t poolSize, size_t nrOfShards, size_t shardAlignment, std::string poolID, std::string poolType );
+
+	// Methods return memory and size of shard with given index
+	void* GetShardMemory( size_t index ) const;
+	size_t GetShardSize( size_t index ) const;
+
+	// Methods set / return pool of shard with given index
+	void SetShardPool( size_t index, MemoryPool* pool ) { m_shards[index].pool = pool; }
+	MemoryPool* GetShardPool( size_t index ) const { return m_shards[index].pool; }
+
+	// Method allocates from shard pool called with its lock held,
+	// returns nullptr if shard cannot satisfy the request
+	virtual void* TryAllocateFromShard( MemoryPool* pool, size_t size ) = 0;
+
+private: // internal methods
+
+	// Method returns index of calling thread home shard
+	size_t GetHomeShard(void) const;
+
+	// Method returns index of shard owning given address
+	size_t GetOwningShard( void* address ) const;
+
+private: // Data members
+
+	// shards memory is split into
+	Shard* m_shards;
+
+	// number of shards
+	size_t m_nrOfShards;
+
+	// size of each shard, multiple of shard alignment
+	size_t m_shardSize;
+
+	// index of shard VerifyHeap continues with
+	size_t m_verifyShard;
+};
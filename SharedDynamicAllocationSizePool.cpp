@@ -0,0 +1,688 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "SharedDynamicAllocationSizePool.h"
+
+#include <assert.h>
+
+// Constructor, formats pool memory or attaches to pool formatted by other process,
+// attached header is checked once magic shows formatting was completed
+SharedDynamicAllocationSizePool::SharedDynamicAllocationSizePool( void* memory, size_t poolSize, std::string poolID, bool format, bool waitForFormat ):
+	MemoryPool( memory, poolSize, poolID, "SharedDynamicAllocationSizePool" ),
+	m_header( reinterpret_cast<PoolHeader*>(memory) ),
+	m_OVERHEAD( sizeof( AllocationBlock ) ),
+	m_isValid( false )
+{
+	assert( poolSize > (HEADER_SIZE + m_OVERHEAD + ALIGNMENT) && " Pool Size to small" );
+
+	// memory region failed to map, pool stays invalid
+	if(memory == nullptr)
+	{
+		return;
+	}
+
+	if(format == false)
+	{
+		m_isValid = WaitForSharedFormat( m_header->magic, MAGIC, waitForFormat ? SHARED_ATTACH_ATTEMPTS : 0 ) &&
+					m_header->version == VERSION && m_header->poolSize == poolSize &&
+					m_header->layoutChecksum == CalculateLayoutChecksum();
+		return;
+	}
+
+	// pool stays invalid for attaching processes until formatting completes
+	m_header->magic.store( 0, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+
+	m_header->version = VERSION;
+	m_header->poolSize = poolSize;
+	m_header->lock.Initialize();
+
+	m_header->recycledHead = 0;
+	m_header->recycledTail = 0;
+
+	m_header->nrOfAllocations = 0;
+	m_header->totalAllocated = 0;
+	m_header->nrOfBlocks = 0;
+	m_header->totalOverhead = HEADER_SIZE + m_OVERHEAD;
+	m_header->rootObject = 0;
+	m_header->verifyCursor = 0;
+
+	// Create the main memory block, its size is kept multiple of alignment
+	uint64_t mainSize = ((poolSize - HEADER_SIZE - m_OVERHEAD) / ALIGNMENT) * ALIGNMENT;
+	m_header->mainBlock = ToOffset( CreateBlock( HEADER_SIZE, mainSize ) );
+
+	m_header->layoutChecksum = CalculateLayoutChecksum();
+
+	// magic is written last so attaching processes never see half formatted pool
+	m_header->magic.store( MAGIC, std::memory_order_release );
+	m_isValid = true;
+}
+///////////////////////////////////////////////////////////
+
+// Destructor, pool state stays in memory for other processes
+SharedDynamicAllocationSizePool::~SharedDynamicAllocationSizePool(void)
+{
+	m_header = nullptr;
+}
+///////////////////////////////////////////////////////////
+
+// Method allocates memory block of requested size
+void*
+SharedDynamicAllocationSizePool::Allocate( size_t requestedSize )
+{
+	void* address = SharedDynamicAllocationSizePool::TryAllocate( requestedSize );
+
+	assert( address != nullptr && "No Free Memory Or Pool has become fragmented" );
+	return address;
+}
+///////////////////////////////////////////////////////////
+
+// Method allocates memory block of requested size, returns nullptr if
+// no free memory available or available memory is not big enough
+void*
+SharedDynamicAllocationSizePool::TryAllocate( size_t requestedSize )
+{
+	// request is rejected before rounding so the size cannot wrap
+	if(requestedSize > ~(size_t)0 - (ALIGNMENT - 1))
+	{
+		return nullptr;
+	}
+
+	// sizes are kept multiple of alignment so every block header stays aligned
+	uint64_t size = ((requestedSize + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+	if(size == 0)
+	{
+		size = ALIGNMENT;
+	}
+
+	ProcessSharedLockGuard lock( m_header->lock );
+
+	AllocationBlock* blockToUse = FindBlockOfBestSize( size );
+	if(blockToUse != nullptr)
+	{
+		blockToUse = RecycleBlock( blockToUse, size );
+	}
+	else
+	{
+		blockToUse = AllocateFromMainBlock( size );
+	}
+
+	if(blockToUse == nullptr)
+	{
+		return nullptr;
+	}
+
+	m_header->nrOfAllocations++;
+	m_header->totalAllocated += blockToUse->allocSize;
+
+	return (++blockToUse);
+}
+///////////////////////////////////////////////////////////
+
+// Method used to return previously allocated memory
+void
+SharedDynamicAllocationSizePool::Deallocate( void* address )
+{
+#ifdef _DEBUG
+	assert( CheckIfAllocatedHere( address ) == true && "Memory wasn't allocated in this pool !" );
+#endif
+
+	AllocationBlock* returnedBlock = reinterpret_cast<AllocationBlock*>(address);
+	returnedBlock--;
+
+	ProcessSharedLockGuard lock( m_header->lock );
+
+	m_header->nrOfAllocations--;
+	m_header->totalAllocated -= returnedBlock->allocSize;
+
+	DeallocateBlock( returnedBlock );
+}
+///////////////////////////////////////////////////////////
+
+// Sized Deallocate, header is needed to merge neighbours
+// so size is only verified in debug mode
+void
+SharedDynamicAllocationSizePool::Deallocate( void* address, size_t size )
+{
+#ifdef _DEBUG
+	assert( size <= (reinterpret_cast<AllocationBlock*>(address) - 1)->allocSize && "Size does not match allocation" );
+#endif
+	(void)size;
+
+	Deallocate( address );
+}
+///////////////////////////////////////////////////////////
+
+// Method returns offset of address from the start of pool memory
+uint64_t
+SharedDynamicAllocationSizePool::GetOffset( const void* address ) const
+{
+	if(address == nullptr)
+	{
+		return 0;
+	}
+	return (uint64_t)(reinterpret_cast<const char*>(address) - reinterpret_cast<const char*>(m_poolMemory));
+}
+///////////////////////////////////////////////////////////
+
+// Method returns address of offset in this process
+void*
+SharedDynamicAllocationSizePool::GetAddress( uint64_t offset ) const
+{
+	if(offset == 0)
+	{
+		return nullptr;
+	}
+	return reinterpret_cast<char*>(m_poolMemory) + offset;
+}
+///////////////////////////////////////////////////////////
+
+// Method stores offset of root object
+void
+SharedDynamicAllocationSizePool::SetRootOffset( uint64_t offset )
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+	m_header->rootObject = offset;
+}
+///////////////////////////////////////////////////////////
+
+// Method returns offset of root object
+uint64_t
+SharedDynamicAllocationSizePool::GetRootOffset(void) const
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+	return m_header->rootObject;
+}
+///////////////////////////////////////////////////////////
+
+// Methods return values stored in pool header
+size_t
+SharedDynamicAllocationSizePool::GetNumberOfAllocations( void ) const
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+	return (size_t)m_header->nrOfAllocations;
+}
+
+size_t
+SharedDynamicAllocationSizePool::GetTotalAllocated( void ) const
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+	return (size_t)m_header->totalAllocated;
+}
+
+size_t
+SharedDynamicAllocationSizePool::GetNumberOfBlocks() const
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+	return (size_t)m_header->nrOfBlocks;
+}
+
+size_t
+SharedDynamicAllocationSizePool::GetTotalOverhead(void) const
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+	return (size_t)m_header->totalOverhead;
+}
+///////////////////////////////////////////////////////////
+
+
+// Method checks pool consistency, every block is visited once
+// so the walk is proportional to number of blocks in pool
+bool
+SharedDynamicAllocationSizePool::Verify(void) const
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+
+	if(m_header->magic.load( std::memory_order_acquire ) != MAGIC || m_header->version != VERSION ||
+	   m_header->layoutChecksum != CalculateLayoutChecksum())
+	{
+		return false;
+	}
+
+	uint64_t poolSize = m_header->poolSize;
+	uint64_t maxBlocks = (poolSize - HEADER_SIZE) / m_OVERHEAD;
+
+	uint64_t nrOfBlocks = 0;
+	uint64_t nrOfFreeBlocks = 0;
+	uint64_t nrOfAllocations = 0;
+	uint64_t totalAllocated = 0;
+
+	uint64_t previous = 0;
+	uint64_t offset = HEADER_SIZE;
+
+	// walk physical chain, each block must start where previous one ends
+	// and point back at it, chain must end exactly at the main block if any
+	while(offset != 0)
+	{
+		if(offset < HEADER_SIZE || (offset % ALIGNMENT) != 0 || offset + m_OVERHEAD > poolSize || nrOfBlocks > maxBlocks)
+		{
+			return false;
+		}
+
+		const AllocationBlock* block = ToBlock( offset );
+		if(block->PhysicalPrevious != previous || offset + m_OVERHEAD + block->allocSize > poolSize)
+		{
+			return false;
+		}
+
+		if(block->PhysicalNext != 0 && block->PhysicalNext != offset + m_OVERHEAD + block->allocSize)
+		{
+			return false;
+		}
+
+		if(block->isAllocated != 0)
+		{
+			nrOfAllocations++;
+			totalAllocated += block->allocSize;
+		}
+		else if(offset != m_header->mainBlock)
+		{
+			nrOfFreeBlocks++;
+		}
+
+		nrOfBlocks++;
+		previous = offset;
+		offset = block->PhysicalNext;
+	}
+
+	if(m_header->mainBlock != 0 && m_header->mainBlock != previous)
+	{
+		return false;
+	}
+
+	// every free block except main block must be on recycled list
+	uint64_t nrOfRecycled = 0;
+	uint64_t recycledPrevious = 0;
+	for(uint64_t recycled = m_header->recycledHead; recycled != 0; recycled = ToBlock( recycled )->LogicalNext)
+	{
+		if(recycled < HEADER_SIZE || recycled + m_OVERHEAD > poolSize || nrOfRecycled > nrOfFreeBlocks ||
+		   ToBlock( recycled )->isAllocated != 0 || ToBlock( recycled )->LogicalPrevious != recycledPrevious)
+		{
+			return false;
+		}
+		nrOfRecycled++;
+		recycledPrevious = recycled;
+	}
+
+	// main block is not counted by nrOfBlocks
+	return nrOfRecycled == nrOfFreeBlocks &&
+		   recycledPrevious == m_header->recycledTail &&
+		   nrOfAllocations == m_header->nrOfAllocations &&
+		   totalAllocated == m_header->totalAllocated &&
+		   nrOfBlocks == m_header->nrOfBlocks + 1;
+}
+///////////////////////////////////////////////////////////
+
+// Method continues verification pass along physical links, pass stops
+// at first corrupted block as its links can not be followed
+bool
+SharedDynamicAllocationSizePool::VerifyHeap( size_t maxBlocks )
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+
+	uint64_t poolSize = m_header->poolSize;
+
+	if(m_header->verifyCursor == 0)
+	{
+		m_header->verifyCursor = HEADER_SIZE;
+
+		if(ToBlock( HEADER_SIZE )->PhysicalPrevious != 0)
+		{
+			m_header->verifyCursor = 0;
+			ReportCorruption( "First block has previous block", GetAddress( HEADER_SIZE ) );
+			return true;
+		}
+	}
+
+	for(size_t i = 0; i < maxBlocks && m_header->verifyCursor != 0; i++)
+	{
+		uint64_t offset = m_header->verifyCursor;
+		const char* problem = nullptr;
+
+		if(offset < HEADER_SIZE || (offset % ALIGNMENT) != 0 || offset + m_OVERHEAD > poolSize)
+		{
+			problem = "Block link out of pool";
+		}
+		else
+		{
+			const AllocationBlock* block = ToBlock( offset );
+			uint64_t end = offset + m_OVERHEAD + block->allocSize;
+
+			if(block->allocSize > poolSize || end > poolSize)
+			{
+				problem = "Block size corrupted";
+			}
+			else if(block->PhysicalNext == 0)
+			{
+				if(m_header->mainBlock != 0 && m_header->mainBlock != offset)
+				{
+					problem = "Last block is not main block";
+				}
+			}
+			else if(block->PhysicalNext != end || end + m_OVERHEAD > poolSize)
+			{
+				problem = "Next block link corrupted";
+			}
+			else if(ToBlock( end )->PhysicalPrevious != offset)
+			{
+				problem = "Next block does not link back";
+			}
+			else if(block->isAllocated == 0 && ToBlock( end )->isAllocated == 0)
+			{
+				problem = "Free blocks were not merged";
+			}
+		}
+
+		if(problem != nullptr)
+		{
+			m_header->verifyCursor = 0;
+			ReportCorruption( problem, GetAddress( offset ) );
+			return true;
+		}
+
+		m_header->verifyCursor = ToBlock( offset )->PhysicalNext;
+	}
+
+	return m_header->verifyCursor == 0;
+}
+///////////////////////////////////////////////////////////
+
+// Method resets pool lock to unlocked state, verification pass of
+// process that stopped may point at block it was merging so it is dropped
+void
+SharedDynamicAllocationSizePool::ResetLock(void)
+{
+	m_header->lock.Initialize();
+	m_header->verifyCursor = 0;
+}
+///////////////////////////////////////////////////////////
+
+// Method calculates FNV-1a checksum of fields that never change after
+// pool is formatted, together with layout constants of this build
+uint64_t
+SharedDynamicAllocationSizePool::CalculateLayoutChecksum(void) const
+{
+	const uint64_t fields[] = { MAGIC, m_header->version, m_header->poolSize,
+								HEADER_SIZE, sizeof( AllocationBlock ), ALIGNMENT };
+
+	uint64_t checksum = 0xCBF29CE484222325ull;
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(fields);
+
+	for(size_t i = 0; i < sizeof( fields ); i++)
+	{
+		checksum ^= bytes[i];
+		checksum *= 0x100000001B3ull;
+	}
+
+	return checksum;
+}
+///////////////////////////////////////////////////////////
+
+
+/******************* Internal Methods *********************/
+
+// internal methods used to convert offsets to blocks and back
+SharedDynamicAllocationSizePool::AllocationBlock*
+SharedDynamicAllocationSizePool::ToBlock( uint64_t offset ) const
+{
+	if(offset == 0)
+	{
+		return nullptr;
+	}
+	return reinterpret_cast<AllocationBlock*>(reinterpret_cast<char*>(m_poolMemory) + offset);
+}
+
+uint64_t
+SharedDynamicAllocationSizePool::ToOffset( const AllocationBlock* block ) const
+{
+	if(block == nullptr)
+	{
+		return 0;
+	}
+	return (uint64_t)(reinterpret_cast<const char*>(block) - reinterpret_cast<const char*>(m_poolMemory));
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to search through recycled blocks list
+// returns block of exactly requested size or the smallest block
+// allocation can be done from, nullptr if no such block exist
+SharedDynamicAllocationSizePool::AllocationBlock*
+SharedDynamicAllocationSizePool::FindBlockOfBestSize( uint64_t requestedSize ) const
+{
+	AllocationBlock* bestSoFar = nullptr;
+
+	for(AllocationBlock* block = ToBlock( m_header->recycledHead ); block != nullptr; block = ToBlock( block->LogicalNext ))
+	{
+		if(block->allocSize == requestedSize)
+		{
+			return block;
+		}
+
+		if(block->allocSize > requestedSize && (bestSoFar == nullptr || bestSoFar->allocSize > block->allocSize))
+		{
+			bestSoFar = block;
+		}
+	}
+
+	return bestSoFar;
+}
+///////////////////////////////////////////////////////////
+
+// Internal Method used to recycle block found on recycled blocks list
+// block is split if big enough, remainder goes back to recycled list
+SharedDynamicAllocationSizePool::AllocationBlock*
+SharedDynamicAllocationSizePool::RecycleBlock( AllocationBlock* blockToUse, uint64_t requestedSize )
+{
+	RemoveRecycled( blockToUse );
+
+	// check if block is big enough to be split, remainder must
+	// be able to hold at least one aligned allocation
+	if(blockToUse->allocSize - requestedSize >= m_OVERHEAD + ALIGNMENT)
+	{
+		uint64_t offset = ToOffset( blockToUse ) + m_OVERHEAD + requestedSize;
+		AllocationBlock* newBlock = CreateBlock( offset, blockToUse->allocSize - requestedSize - m_OVERHEAD );
+
+		// update physical links
+		newBlock->PhysicalPrevious = ToOffset( blockToUse );
+		newBlock->PhysicalNext = blockToUse->PhysicalNext;
+		if(newBlock->PhysicalNext != 0)
+		{
+			ToBlock( newBlock->PhysicalNext )->PhysicalPrevious = offset;
+		}
+		blockToUse->PhysicalNext = offset;
+
+		InsertRecycled( newBlock );
+
+		blockToUse->allocSize = requestedSize;
+
+		m_header->totalOverhead += m_OVERHEAD;
+		m_header->nrOfBlocks++;
+	}
+
+	blockToUse->isAllocated = 1;
+	return blockToUse;
+}
+///////////////////////////////////////////////////////////
+
+// Internal method used to allocate block from main block, main block
+// is split if big enough else it is used "as it is"
+SharedDynamicAllocationSizePool::AllocationBlock*
+SharedDynamicAllocationSizePool::AllocateFromMainBlock( uint64_t requestedSize )
+{
+	AllocationBlock* mainBlock = ToBlock( m_header->mainBlock );
+	if(mainBlock == nullptr || mainBlock->allocSize < requestedSize)
+	{
+		return nullptr;
+	}
+
+	if(mainBlock->allocSize - requestedSize >= m_OVERHEAD + ALIGNMENT)
+	{
+		uint64_t offset = m_header->mainBlock + m_OVERHEAD + requestedSize;
+		AllocationBlock* newMain = CreateBlock( offset, mainBlock->allocSize - requestedSize - m_OVERHEAD );
+
+		newMain->PhysicalPrevious = m_header->mainBlock;
+		mainBlock->PhysicalNext = offset;
+		mainBlock->allocSize = requestedSize;
+
+		m_header->mainBlock = offset;
+		m_header->totalOverhead += m_OVERHEAD;
+		m_header->nrOfBlocks++;
+	}
+	else
+	{
+		// main block used "as it is", no free space left in main memory
+		m_header->mainBlock = 0;
+	}
+
+	mainBlock->isAllocated = 1;
+	return mainBlock;
+}
+///////////////////////////////////////////////////////////
+
+// Internal method used to return block into pool, block is merged with
+// free physical neighbours, if it ends up being the last physical block
+// it becomes the main block, else it goes to recycled list
+void
+SharedDynamicAllocationSizePool::DeallocateBlock( AllocationBlock* returnedBlock )
+{
+	returnedBlock->isAllocated = 0;
+
+	// merge with preceding block if it is free, preceding block survives
+	AllocationBlock* physicalPrev = ToBlock( returnedBlock->PhysicalPrevious );
+	if(physicalPrev != nullptr && physicalPrev->isAllocated == 0)
+	{
+		RemoveRecycled( physicalPrev );
+
+		physicalPrev->allocSize += returnedBlock->allocSize + m_OVERHEAD;
+		physicalPrev->PhysicalNext = returnedBlock->PhysicalNext;
+		if(physicalPrev->PhysicalNext != 0)
+		{
+			ToBlock( physicalPrev->PhysicalNext )->PhysicalPrevious = ToOffset( physicalPrev );
+		}
+
+		if(m_header->verifyCursor == ToOffset( returnedBlock ))
+		{
+			m_header->verifyCursor = ToOffset( physicalPrev );
+		}
+		returnedBlock = physicalPrev;
+
+		m_header->totalOverhead -= m_OVERHEAD;
+		m_header->nrOfBlocks--;
+	}
+
+	uint64_t physicalNext = returnedBlock->PhysicalNext;
+
+	// last physical block with main block used up becomes the main block
+	if(physicalNext == 0 && m_header->mainBlock == 0)
+	{
+		m_header->mainBlock = ToOffset( returnedBlock );
+	}
+	// next block is the main block, returned block absorbs it and becomes the main block
+	else if(physicalNext != 0 && physicalNext == m_header->mainBlock)
+	{
+		returnedBlock->allocSize += ToBlock( physicalNext )->allocSize + m_OVERHEAD;
+		returnedBlock->PhysicalNext = 0;
+		if(m_header->verifyCursor == physicalNext)
+		{
+			m_header->verifyCursor = ToOffset( returnedBlock );
+		}
+
+		m_header->mainBlock = ToOffset( returnedBlock );
+		m_header->totalOverhead -= m_OVERHEAD;
+		m_header->nrOfBlocks--;
+	}
+	// next block is free, returned block absorbs it and goes to recycled list
+	else if(physicalNext != 0 && ToBlock( physicalNext )->isAllocated == 0)
+	{
+		AllocationBlock* nextBlock = ToBlock( physicalNext );
+		RemoveRecycled( nextBlock );
+
+		returnedBlock->allocSize += nextBlock->allocSize + m_OVERHEAD;
+		returnedBlock->PhysicalNext = nextBlock->PhysicalNext;
+		if(returnedBlock->PhysicalNext != 0)
+		{
+			ToBlock( returnedBlock->PhysicalNext )->PhysicalPrevious = ToOffset( returnedBlock );
+		}
+		if(m_header->verifyCursor == physicalNext)
+		{
+			m_header->verifyCursor = ToOffset( returnedBlock );
+		}
+
+		InsertRecycled( returnedBlock );
+
+		m_header->totalOverhead -= m_OVERHEAD;
+		m_header->nrOfBlocks--;
+	}
+	else
+	{
+		InsertRecycled( returnedBlock );
+	}
+}
+///////////////////////////////////////////////////////////
+
+// internal method used to create block of given size at given offset
+SharedDynamicAllocationSizePool::AllocationBlock*
+SharedDynamicAllocationSizePool::CreateBlock( uint64_t atOffset, uint64_t size ) const
+{
+	AllocationBlock* block = ToBlock( atOffset );
+	block->LogicalNext = 0;
+	block->LogicalPrevious = 0;
+	block->PhysicalNext = 0;
+	block->PhysicalPrevious = 0;
+
+	block->allocSize = size;
+	block->isAllocated = 0;
+
+	return block;
+}
+///////////////////////////////////////////////////////////
+
+// internal method inserts block at the end of recycled list
+void
+SharedDynamicAllocationSizePool::InsertRecycled( AllocationBlock* block )
+{
+	uint64_t offset = ToOffset( block );
+
+	block->LogicalNext = 0;
+	block->LogicalPrevious = m_header->recycledTail;
+
+	if(m_header->recycledTail != 0)
+	{
+		ToBlock( m_header->recycledTail )->LogicalNext = offset;
+	}
+	else
+	{
+		m_header->recycledHead = offset;
+	}
+	m_header->recycledTail = offset;
+}
+///////////////////////////////////////////////////////////
+
+// internal method removes block from recycled list
+void
+SharedDynamicAllocationSizePool::RemoveRecycled( AllocationBlock* block )
+{
+	if(block->LogicalPrevious != 0)
+	{
+		ToBlock( block->LogicalPrevious )->LogicalNext = block->LogicalNext;
+	}
+	else
+	{
+		m_header->recycledHead = block->LogicalNext;
+	}
+
+	if(block->LogicalNext != 0)
+	{
+		ToBlock( block->LogicalNext )->LogicalPrevious = block->LogicalPrevious;
+	}
+	else
+	{
+		m_header->recycledTail = block->LogicalPrevious;
+	}
+
+	block->LogicalNext = 0;
+	block->LogicalPrevious = 0;
+}
+///////////////////////////////////////////////////////////
@@ -0,0 +1,184 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MemoryPool.h"
+#include "ProcessSharedLock.h"
+
+#include <atomic>
+#include <cstdint>
+
+
+//	Class:		SharedDynamicAllocationSizePool
+//	Author:		Rafal Rebisz
+//	Purpose:	Defines a memory pool from witch allocations of any size
+//				can be done by several processes sharing the pool memory
+
+//	Use:		First process instantiates passing pointer to shared memory,
+//				its size, ID and format set to true, other processes pass
+//				format set to false to attach to the pool and must check
+//				IsValid before using it. Allocated memory is exchanged between
+//				processes with GetOffset / GetAddress
+
+//	NOTE:		All pool state lives in pool memory, block links are offsets
+//				from the start of the memory so each process may map it at
+//				different address. Operations are serialized by process shared
+//				lock placed in pool header. Allocation sizes are rounded up
+//				to 16 bytes and returned memory is 16 byte aligned. Magic is
+//				cleared when formatting starts and stored last with release,
+//				attaching process waits for it with acquire. VerifyHeap cursor
+//				is kept in pool header, merge moves it to block that survives.
+//				Best fit, split and merge follow DynamicAllocationSizePool but
+//				are not shared with it: its blocks are linked by pointers and
+//				carry run, quick list, handle and hardening state this layout
+//				has no room for, sharing the walk would put offset conversion
+//				or virtual link access on its allocation path. Fix to block
+//				splitting or merging there has to be checked against this pool
+
+class SharedDynamicAllocationSizePool: public MemoryPool
+{
+private: // Structures
+
+	// semantic structure defines Allocation Block, links are offsets
+	// from the start of pool memory, offset 0 stands for no block
+	struct AllocationBlock
+	{
+	public:
+		uint64_t LogicalNext;
+		uint64_t LogicalPrevious;
+
+		uint64_t PhysicalNext;
+		uint64_t PhysicalPrevious;
+
+		uint64_t allocSize;
+		uint64_t isAllocated;
+	};
+	//********************************************************//
+
+	// semantic structure defines pool header placed at the start of pool memory
+	struct PoolHeader
+	{
+	public:
+		// set once pool is fully formatted
+		std::atomic<uint64_t> magic;
+		uint64_t version;
+		uint64_t poolSize;
+
+		ProcessSharedLock lock;
+
+		uint64_t mainBlock;
+		uint64_t recycledHead;
+		uint64_t recycledTail;
+
+		uint64_t nrOfAllocations;
+		uint64_t totalAllocated;
+		uint64_t nrOfBlocks;
+		uint64_t totalOverhead;
+
+		// offset of object processes agreed to use as entry point
+		uint64_t rootObject;
+
+		// checksum of layout fields written when pool is formatted
+		uint64_t layoutChecksum;
+
+		// block VerifyHeap of any process continues from,
+		// 0 if no pass is in progress
+		uint64_t verifyCursor;
+	};
+	//********************************************************//
+
+	// Pool layout constants
+	static const uint64_t MAGIC = 0x4C4F4F5044524853ull;
+	static const uint64_t VERSION = 3;
+	static const size_t ALIGNMENT = 16;
+	static const size_t HEADER_SIZE = ((sizeof( PoolHeader ) + 63) / 64) * 64;
+
+public: // Methods
+
+	// Constructor, attaching process waits for formatting process unless waitForFormat is false
+	SharedDynamicAllocationSizePool( void* memory, size_t poolSize, std::string poolID, bool format, bool waitForFormat = true );
+	// Destructor
+	virtual ~SharedDynamicAllocationSizePool(void);
+
+	// Methods used to allocate and free memory
+	virtual void* Allocate( size_t requestedSize );
+	virtual void Deallocate( void* address );
+	virtual void Deallocate( void* address, size_t size );
+
+	// Allocates memory, returns nullptr if request cannot be satisfied
+	virtual void* TryAllocate( size_t requestedSize );
+
+	// Returns false if attached memory does not hold fully formatted pool of
+	// this version and size, pool must not be used then
+	virtual bool IsValid(void) const { return m_isValid; }
+
+	// Convert between address in this process and offset valid in every process
+	uint64_t GetOffset( const void* address ) const;
+	void* GetAddress( uint64_t offset ) const;
+
+	// Store / load offset of shared root object
+	void SetRootOffset( uint64_t offset );
+	uint64_t GetRootOffset(void) const;
+
+	// Walks every block along physical links and checks links, sizes,
+	// recycled list and counters, returns false if pool is inconsistent
+	bool Verify(void) const;
+
+	// Checks links of at most maxBlocks blocks continuing where previous call
+	// of any process stopped, returns true once pass over all blocks is finished
+	virtual bool VerifyHeap( size_t maxBlocks );
+
+	// Values are read from pool header
+	virtual size_t GetNumberOfAllocations( void ) const;
+	virtual size_t GetTotalAllocated( void ) const;
+	virtual size_t GetNumberOfBlocks() const;
+	virtual size_t GetTotalOverhead(void) const;
+
+protected: // internal methods
+
+	// Resets pool lock, used when memory is known not to be shared
+	// with any running process, e.g. after restart of the only user
+	void ResetLock(void);
+
+	// Method returns checksum of header fields describing pool layout
+	uint64_t CalculateLayoutChecksum(void) const;
+
+private: // internal methods
+
+	// Methods convert offset to block and back
+	AllocationBlock* ToBlock( uint64_t offset ) const;
+	uint64_t ToOffset( const AllocationBlock* block ) const;
+
+	// Method used to find block of best size in recycled block list
+	AllocationBlock* FindBlockOfBestSize( uint64_t requestedSize ) const;
+
+	// Method used to recycle block found by method above
+	AllocationBlock* RecycleBlock( AllocationBlock* blockToUse, uint64_t requestedSize );
+
+	// Method used to allocate block from the front of main block
+	AllocationBlock* AllocateFromMainBlock( uint64_t requestedSize );
+
+	// Method returns block into pool and merges it with free neighbours
+	void DeallocateBlock( AllocationBlock* returnedBlock );
+
+	// Method creates new block of given size at given offset
+	AllocationBlock* CreateBlock( uint64_t atOffset, uint64_t size ) const;
+
+	// Methods insert / remove block into recycled list
+	void InsertRecycled( AllocationBlock* block );
+	void RemoveRecycled( AllocationBlock* block );
+
+private: // Members
+
+	// header placed at the start of pool memory
+	PoolHeader* m_header;
+
+	// overhead for each allocation in bytes
+	const uint64_t m_OVERHEAD;
+
+	// true if pool was formatted or attached pool header is valid
+	bool m_isValid;
+};
@@ -0,0 +1,208 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "SharedFixedAllocationSizePool.h"
+
+#include <assert.h>
+
+// Constructor, formats pool memory or attaches to pool formatted by other process
+SharedFixedAllocationSizePool::SharedFixedAllocationSizePool( void* memory, size_t poolSize, size_t blockSize, std::string poolID, bool format ):
+	MemoryPool( memory, poolSize, poolID, "SharedFixedAllocationSizePool" ),
+	m_header( reinterpret_cast<PoolHeader*>(memory) ),
+	m_isValid( false )
+{
+	if(format == false)
+	{
+		m_isValid = WaitForSharedFormat( m_header->magic, MAGIC, SHARED_ATTACH_ATTEMPTS ) &&
+					m_header->version == VERSION && m_header->poolSize == poolSize &&
+					m_header->blockSize >= blockSize && m_header->nrOfBlocks == (poolSize - HEADER_SIZE) / m_header->blockSize;
+		return;
+	}
+
+	assert( blockSize >= sizeof( AllocationBlock ) && "Memory pool does not support allocations smaller than 8 bytes" );
+	assert( poolSize >= HEADER_SIZE + blockSize && " Pool Size to small" );
+
+	// blocks are kept 8 byte aligned so free list links stay aligned
+	blockSize = ((blockSize + sizeof( AllocationBlock ) - 1) / sizeof( AllocationBlock )) * sizeof( AllocationBlock );
+
+	// pool stays invalid for attaching processes until formatting completes
+	m_header->magic.store( 0, std::memory_order_relaxed );
+	std::atomic_thread_fence( std::memory_order_release );
+
+	m_header->version = VERSION;
+	m_header->poolSize = poolSize;
+	m_header->blockSize = blockSize;
+	m_header->nrOfBlocks = (poolSize - HEADER_SIZE) / blockSize;
+	m_header->lock.Initialize();
+
+	m_header->freeBlocks = 0;
+	m_header->untouchedBlock = 0;
+	m_header->nrOfAllocations = 0;
+	m_header->verifyCursor = 0;
+
+	// magic is written last so attaching processes never see half formatted pool
+	m_header->magic.store( MAGIC, std::memory_order_release );
+	m_isValid = true;
+}
+/////////////////////////////////////////////////////
+
+// Destructor, pool state stays in memory for other processes
+SharedFixedAllocationSizePool::~SharedFixedAllocationSizePool()
+{
+	m_header = nullptr;
+}
+/////////////////////////////////////////////////////
+
+// Method used to allocate memory and return it's address
+void*
+SharedFixedAllocationSizePool::Allocate( size_t size )
+{
+	void* address = SharedFixedAllocationSizePool::TryAllocate( size );
+
+	assert( address != nullptr && "No Free Memory" );
+	return address;
+}
+/////////////////////////////////////////////////////
+
+// Method used to allocate block, returned blocks are reused first
+void*
+SharedFixedAllocationSizePool::TryAllocate( size_t size )
+{
+	assert( size <= m_header->blockSize && "Incorrect allocation size" );
+	(void)size;
+
+	ProcessSharedLockGuard lock( m_header->lock );
+
+	uint64_t offset = m_header->freeBlocks;
+	if(offset != 0)
+	{
+		m_header->freeBlocks = reinterpret_cast<AllocationBlock*>(GetAddress( offset ))->nextFreeBlock;
+		if(offset == m_header->verifyCursor)
+		{
+			m_header->verifyCursor = m_header->freeBlocks;
+		}
+	}
+	else if(m_header->untouchedBlock < m_header->nrOfBlocks)
+	{
+		offset = HEADER_SIZE + (m_header->untouchedBlock * m_header->blockSize);
+		m_header->untouchedBlock++;
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	m_header->nrOfAllocations++;
+
+	return GetAddress( offset );
+}
+/////////////////////////////////////////////////////
+
+// Method used to return memory into pool
+void
+SharedFixedAllocationSizePool::Deallocate( void* address )
+{
+#ifdef _DEBUG
+	assert( CheckIfAllocatedHere( address ) == true && "Memory wasn't allocated in this pool !" );
+#endif
+
+	AllocationBlock* returnedBlock = reinterpret_cast<AllocationBlock*>(address);
+
+	ProcessSharedLockGuard lock( m_header->lock );
+
+	returnedBlock->nextFreeBlock = m_header->freeBlocks;
+	m_header->freeBlocks = GetOffset( address );
+
+	m_header->nrOfAllocations--;
+}
+///////////////////////////////////////////////////////////
+
+// Sized Deallocate, all blocks have the same size
+// so size is only verified in debug mode
+void
+SharedFixedAllocationSizePool::Deallocate( void* address, size_t size )
+{
+#ifdef _DEBUG
+	assert( size <= m_header->blockSize && "Size does not match allocation" );
+#endif
+	(void)size;
+
+	Deallocate( address );
+}
+/////////////////////////////////////////////////////
+
+// Method walks free list from its head, list only changes at its head so block
+// walk stopped at stays in the list until it is allocated, then walk continues
+// from block that followed it. Blocks returned during the pass are checked by
+// next pass
+bool
+SharedFixedAllocationSizePool::VerifyHeap( size_t maxBlocks )
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+
+	if(m_header->verifyCursor == 0)
+	{
+		m_header->verifyCursor = m_header->freeBlocks;
+	}
+
+	for(size_t i = 0; i < maxBlocks && m_header->verifyCursor != 0; i++)
+	{
+		uint64_t offset = m_header->verifyCursor;
+
+		// link has to point at start of block that was handed out
+		if(offset < HEADER_SIZE || ((offset - HEADER_SIZE) % m_header->blockSize) != 0 ||
+		   ((offset - HEADER_SIZE) / m_header->blockSize) >= m_header->untouchedBlock)
+		{
+			m_header->verifyCursor = 0;
+			ReportCorruption( "Free list link corrupted", GetAddress( offset ) );
+			return true;
+		}
+
+		m_header->verifyCursor = reinterpret_cast<AllocationBlock*>(GetAddress( offset ))->nextFreeBlock;
+	}
+
+	return m_header->verifyCursor == 0;
+}
+/////////////////////////////////////////////////////
+
+// Method returns offset of address from the start of pool memory
+uint64_t
+SharedFixedAllocationSizePool::GetOffset( const void* address ) const
+{
+	if(address == nullptr)
+	{
+		return 0;
+	}
+	return (uint64_t)(reinterpret_cast<const char*>(address) - reinterpret_cast<const char*>(m_poolMemory));
+}
+/////////////////////////////////////////////////////
+
+// Method returns address of offset in this process
+void*
+SharedFixedAllocationSizePool::GetAddress( uint64_t offset ) const
+{
+	if(offset == 0)
+	{
+		return nullptr;
+	}
+	return reinterpret_cast<char*>(m_poolMemory) + offset;
+}
+/////////////////////////////////////////////////////
+
+// Methods return values stored in pool header
+size_t
+SharedFixedAllocationSizePool::GetNumberOfAllocations( void ) const
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+	return (size_t)m_header->nrOfAllocations;
+}
+
+size_t
+SharedFixedAllocationSizePool::GetTotalAllocated( void ) const
+{
+	ProcessSharedLockGuard lock( m_header->lock );
+	return (size_t)(m_header->nrOfAllocations * m_header->blockSize);
+}
+/////////////////////////////////////////////////////
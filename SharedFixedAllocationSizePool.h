@@ -0,0 +1,116 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "MemoryPool.h"
+#include "ProcessSharedLock.h"
+
+#include <atomic>
+#include <cstdint>
+
+
+//	Class:		SharedFixedAllocationSizePool
+//	Author:		Rafal Rebisz
+//	Purpose:	Defines a pool of equally sized blocks that can be
+//				allocated by several processes sharing the pool memory
+
+//	Use:		First process instantiates passing pointer to shared memory,
+//				its size, block size, ID and format set to true, other processes
+//				pass format set to false to attach and must check IsValid before
+//				using the pool. Allocated blocks are exchanged between processes
+//				with GetOffset / GetAddress
+
+//	NOTE:		Pool header is placed at the start of memory, remaining memory is
+//				split into blocks. Free list links are offsets from the start of
+//				memory. Blocks are handed out in address order until every block
+//				was used once, so formatting does not touch block memory. Magic is
+//				stored last with release, attaching process waits for it with acquire.
+//				VerifyHeap cursor is kept in pool header as free list changes in
+//				every process, allocation moves it on when it takes its block
+
+class SharedFixedAllocationSizePool: public MemoryPool
+{
+private: // Structures
+
+	// defines allocation block structure, link is an offset, 0 stands for no block
+	struct AllocationBlock
+	{
+		uint64_t nextFreeBlock;
+	};
+
+	// semantic structure defines pool header placed at the start of pool memory
+	struct PoolHeader
+	{
+	public:
+		// set once pool is fully formatted
+		std::atomic<uint64_t> magic;
+		uint64_t version;
+		uint64_t poolSize;
+		uint64_t blockSize;
+		uint64_t nrOfBlocks;
+
+		ProcessSharedLock lock;
+
+		// singly linked list of returned blocks
+		uint64_t freeBlocks;
+		// index of first block that has never been allocated
+		uint64_t untouchedBlock;
+
+		uint64_t nrOfAllocations;
+
+		// free block VerifyHeap of any process continues from,
+		// 0 if no pass is in progress
+		uint64_t verifyCursor;
+	};
+
+	// Pool layout constants
+	static const uint64_t MAGIC = 0x4C4F4F5044584946ull;
+	static const uint64_t VERSION = 2;
+	static const size_t HEADER_SIZE = ((sizeof( PoolHeader ) + 63) / 64) * 64;
+
+public: // Methods
+
+	// Constructor, attaching process waits for formatting process
+	SharedFixedAllocationSizePool( void* memory, size_t poolSize, size_t blockSize, std::string poolID, bool format );
+	// Destructor
+	virtual ~SharedFixedAllocationSizePool();
+
+	// Methods used to allocate and free memory
+	virtual void* Allocate( size_t size );
+	virtual void Deallocate( void* address );
+	virtual void Deallocate( void* address, size_t size );
+
+	// Allocates block, returns nullptr if no free block is left
+	virtual void* TryAllocate( size_t size );
+
+	// Returns false if attached memory does not hold fully formatted
+	// pool of matching layout, pool must not be used then
+	bool IsValid(void) const { return m_isValid; }
+
+	// Convert between address in this process and offset valid in every process
+	uint64_t GetOffset( const void* address ) const;
+	void* GetAddress( uint64_t offset ) const;
+
+	// Returns block size in bytes
+	virtual size_t GetBlockSize() const { return (size_t)m_header->blockSize; }
+
+	// Values are read from pool header
+	virtual size_t GetNumberOfAllocations( void ) const;
+	virtual size_t GetTotalAllocated( void ) const;
+	virtual size_t GetNumberOfBlocks() const { return (size_t)m_header->nrOfBlocks; }
+
+	// Verifies links of at most maxBlocks free blocks continuing where previous
+	// call of any process stopped, returns true once pass is finished
+	virtual bool VerifyHeap( size_t maxBlocks );
+
+private: // Data members
+
+	// header placed at the start of pool memory
+	PoolHeader* m_header;
+
+	// true if pool was formatted or attached pool header is valid
+	bool m_isValid;
+};
@@ -0,0 +1,150 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "SharedMemoryRegion.h"
+
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// number of milliseconds attaching process waits for creator to size the segment
+	const size_t ATTACH_ATTEMPTS = 1000;
+}
+
+// Constructor, creates segment or attaches to existing one, read only
+// attach never creates it, on failure segment is left unmapped
+SharedMemoryRegion::SharedMemoryRegion( std::string name, size_t size, bool attachReadOnly ):
+	m_name( name ),
+	m_address( nullptr ),
+	m_size( size ),
+	m_isCreator( false ),
+	m_handle( nullptr )
+{
+#ifdef _WIN32
+	if(attachReadOnly)
+	{
+		HANDLE handle = OpenFileMappingA( FILE_MAP_READ, FALSE, name.c_str() );
+		if(handle == nullptr)
+		{
+			return;
+		}
+
+		m_handle = handle;
+		m_address = MapViewOfFile( handle, FILE_MAP_READ, 0, 0, size );
+		return;
+	}
+
+	HANDLE handle = CreateFileMappingA( INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+										(DWORD)((unsigned long long)size >> 32), (DWORD)(size & 0xFFFFFFFF), name.c_str() );
+	if(handle == nullptr)
+	{
+		return;
+	}
+
+	m_isCreator = (GetLastError() != ERROR_ALREADY_EXISTS);
+	m_handle = handle;
+	m_address = MapViewOfFile( handle, FILE_MAP_ALL_ACCESS, 0, 0, size );
+#else
+	int fd = -1;
+	if(attachReadOnly)
+	{
+		fd = shm_open( name.c_str(), O_RDONLY, 0 );
+	}
+	else
+	{
+		// try to create segment first, if it already exists attach to it
+		fd = shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600 );
+		if(fd >= 0)
+		{
+			m_isCreator = true;
+			if(ftruncate( fd, (off_t)size ) != 0)
+			{
+				close( fd );
+				shm_unlink( name.c_str() );
+				return;
+			}
+		}
+		else if(errno == EEXIST)
+		{
+			fd = shm_open( name.c_str(), O_RDWR, 0600 );
+		}
+	}
+	if(fd < 0)
+	{
+		return;
+	}
+
+	// creator may not have sized the segment yet
+	struct stat info;
+	for(size_t attempt = 0; ; attempt++)
+	{
+		if(fstat( fd, &info ) != 0 || attempt > ATTACH_ATTEMPTS)
+		{
+			close( fd );
+			return;
+		}
+
+		if((size_t)info.st_size >= size)
+		{
+			break;
+		}
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+
+	void* address = mmap( nullptr, size, attachReadOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0 );
+	close( fd );
+
+	m_address = (address == MAP_FAILED) ? nullptr : address;
+#endif
+}
+/////////////////////////////////////////////////////
+
+// Destructor
+SharedMemoryRegion::~SharedMemoryRegion(void)
+{
+#ifdef _WIN32
+	if(m_address != nullptr)
+	{
+		UnmapViewOfFile( m_address );
+	}
+	if(m_handle != nullptr)
+	{
+		CloseHandle( reinterpret_cast<HANDLE>(m_handle) );
+	}
+#else
+	if(m_address != nullptr)
+	{
+		munmap( m_address, m_size );
+	}
+#endif
+
+	m_address = nullptr;
+	m_handle = nullptr;
+}
+/////////////////////////////////////////////////////
+
+// Method removes segment name from the system
+void
+SharedMemoryRegion::Remove( const std::string& name )
+{
+#ifdef _WIN32
+	// segment is released when last handle is closed
+	(void)name;
+#else
+	shm_unlink( name.c_str() );
+#endif
+}
+/////////////////////////////////////////////////////
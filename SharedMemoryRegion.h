@@ -0,0 +1,70 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <string>
+
+
+//	Class:		SharedMemoryRegion
+//	Author:		Rafal Rebisz
+//	Purpose:	Maps named shared memory segment into process address space
+
+//	Use:		Instantiate passing segment name and size, first process
+//				to open the name creates the segment (IsCreator returns true)
+//				and is expected to format it, other processes attach to it.
+//				Segment name is removed from the system by calling Remove.
+//				Passing attachReadOnly only maps existing segment for reading,
+//				segment is never created. GetAddress returns nullptr if
+//				segment could not be mapped
+
+//	NOTE:		Segment may be mapped at different address in every process,
+//				anything stored in it must not contain absolute pointers. Creator
+//				sizes segment after creating it, attaching process waits until
+//				segment reaches requested size.
+//				POSIX systems use shm_open / mmap, Windows uses paging file
+//				backed file mapping witch lives as long as any process maps it
+
+class SharedMemoryRegion
+{
+public:
+	// Constructor
+	SharedMemoryRegion( std::string name, size_t size, bool attachReadOnly = false );
+	// Destructor, unmaps the segment
+	~SharedMemoryRegion(void);
+
+	// Returns address segment is mapped at in this process
+	void* GetAddress(void) const { return m_address; }
+
+	// Returns true if segment is mapped
+	bool IsValid(void) const { return m_address != nullptr; }
+
+	// Returns segment size
+	size_t GetSize(void) const { return m_size; }
+
+	// Returns segment name
+	const std::string& GetName(void) const { return m_name; }
+
+	// Returns true if this object created the segment
+	bool IsCreator(void) const { return m_isCreator; }
+
+	// Removes segment name, already mapped segments stay valid
+	static void Remove( const std::string& name );
+
+private:
+	// non copyable
+	SharedMemoryRegion( const SharedMemoryRegion& );
+	SharedMemoryRegion& operator=( const SharedMemoryRegion& );
+
+private:
+
+	std::string m_name;
+	void* m_address;
+	size_t m_size;
+	bool m_isCreator;
+
+	// mapping handle, only used on Windows
+	void* m_handle;
+};
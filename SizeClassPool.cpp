@@ -0,0 +1,340 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "SizeClassPool.h"
+
+#include <cstdint>
+#include <new>
+
+// Constructor, pool objects are placed at the start of memory
+// followed by class regions and memory of dynamic pool
+SizeClassPool::SizeClassPool( void* memory, size_t poolSize, size_t classRegionSize, std::string poolID, bool memoryIsZeroed ):
+	MemoryPool( memory, poolSize, poolID, "SizeClassPool" ),
+	m_dynamicPool( nullptr ),
+	m_classMemory( nullptr ),
+	m_classRegionSize( classRegionSize ),
+	m_verifyPool( 0 )
+{
+	assert( (reinterpret_cast<uintptr_t>(memory) % MAX_CLASS_SIZE) == 0 && "Memory must be aligned to largest class size" );
+	assert( classRegionSize >= MAX_CLASS_SIZE && (classRegionSize % MAX_CLASS_SIZE) == 0 && "Incorrect class region size" );
+
+	char* bytePtr = reinterpret_cast<char*>(memory);
+
+	// pool objects
+	size_t metadataSize = (sizeof( FixedAllocationSizePool ) * NR_OF_CLASSES) + sizeof( DynamicAllocationSizePool );
+	metadataSize = ((metadataSize + MAX_CLASS_SIZE - 1) / MAX_CLASS_SIZE) * MAX_CLASS_SIZE;
+
+	m_classMemory = bytePtr + metadataSize;
+	char* dynamicMemory = m_classMemory + (classRegionSize * NR_OF_CLASSES);
+
+	assert( poolSize > (size_t)(dynamicMemory - bytePtr) + MAX_CLASS_SIZE && " Pool Size to small" );
+
+	FixedAllocationSizePool* classPools = reinterpret_cast<FixedAllocationSizePool*>(bytePtr);
+	for(size_t i = 0; i < NR_OF_CLASSES; i++)
+	{
+		size_t classSize = MIN_CLASS_SIZE << i;
+		m_classPools[i] = new (&classPools[i]) FixedAllocationSizePool( m_classMemory + (classRegionSize * i),
+																		classRegionSize / classSize,
+																		classSize, poolID + "_" + std::to_string( classSize ), memoryIsZeroed );
+	}
+
+	m_dynamicPool = new (&classPools[NR_OF_CLASSES]) DynamicAllocationSizePool( dynamicMemory,
+																				poolSize - (size_t)(dynamicMemory - bytePtr),
+																				poolID + "_D", false, memoryIsZeroed );
+}
+/////////////////////////////////////////////////////
+
+// Destructor
+SizeClassPool::~SizeClassPool(void)
+{
+	for(size_t i = 0; i < NR_OF_CLASSES; i++)
+	{
+		m_classPools[i]->~FixedAllocationSizePool();
+		m_classPools[i] = nullptr;
+	}
+
+	m_dynamicPool->~DynamicAllocationSizePool();
+	m_dynamicPool = nullptr;
+}
+/////////////////////////////////////////////////////
+
+// Method used to allocate memory
+void*
+SizeClassPool::Allocate( size_t size )
+{
+	void* address = SizeClassPool::TryAllocate( size );
+
+	assert( address != nullptr && "No Free Memory Or Pool has become fragmented" );
+	return address;
+}
+/////////////////////////////////////////////////////
+
+// Method allocates from size class pool, if request is to big
+// or its class is exhausted dynamic pool is used, pools are
+// called by qualified name so calls are not dispatched virtually
+void*
+SizeClassPool::TryAllocate( size_t size )
+{
+	size_t sizeClass = GetSizeClass( size );
+
+	if(sizeClass < NR_OF_CLASSES)
+	{
+		void* address = m_classPools[sizeClass]->FixedAllocationSizePool::TryAllocate( size );
+		if(address != nullptr)
+		{
+			return address;
+		}
+	}
+
+	if(size > MAX_REQUEST_SIZE)
+	{
+		return nullptr;
+	}
+
+	// sizes are kept multiple of alignment so dynamic pool blocks stay aligned
+	size = ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+	return m_dynamicPool->DynamicAllocationSizePool::TryAllocate( (size == 0) ? ALIGNMENT : size );
+}
+/////////////////////////////////////////////////////
+
+// Method used to allocate zero filled memory
+void*
+SizeClassPool::AllocateZeroed( size_t size )
+{
+	void* address = TryAllocateZeroed( size );
+
+	assert( address != nullptr && "No Free Memory Or Pool has become fragmented" );
+	return address;
+}
+/////////////////////////////////////////////////////
+
+// Method allocates zero filled memory same way as TryAllocate
+void*
+SizeClassPool::TryAllocateZeroed( size_t size )
+{
+	size_t sizeClass = GetSizeClass( size );
+
+	if(sizeClass < NR_OF_CLASSES)
+	{
+		void* address = m_classPools[sizeClass]->TryAllocateZeroed( size );
+		if(address != nullptr)
+		{
+			return address;
+		}
+	}
+
+	if(size > MAX_REQUEST_SIZE)
+	{
+		return nullptr;
+	}
+
+	size_t blockSize = ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+	return m_dynamicPool->TryAllocateZeroed( (blockSize == 0) ? ALIGNMENT : blockSize );
+}
+/////////////////////////////////////////////////////
+
+// Method allocates aligned memory, blocks of each class are aligned to class
+// size so class of at least alignment size is used, dynamic pool is asked for
+// aligned block when class is exhausted or alignment is bigger than classes
+void*
+SizeClassPool::TryAllocateAligned( size_t size, size_t alignment )
+{
+	if(alignment <= ALIGNMENT)
+	{
+		return SizeClassPool::TryAllocate( size );
+	}
+
+	if(size < alignment)
+	{
+		size = alignment;
+	}
+
+	size_t sizeClass = GetSizeClass( size );
+
+	if(sizeClass < NR_OF_CLASSES)
+	{
+		void* address = m_classPools[sizeClass]->FixedAllocationSizePool::TryAllocate( size );
+		if(address != nullptr)
+		{
+			return address;
+		}
+	}
+
+	if(size > MAX_REQUEST_SIZE)
+	{
+		return nullptr;
+	}
+
+	size = ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+	return m_dynamicPool->TryAllocateAligned( size, alignment );
+}
+/////////////////////////////////////////////////////
+
+// Method returns memory into the pool owning the address
+void
+SizeClassPool::Deallocate( void* address )
+{
+#ifdef _DEBUG
+	assert( CheckIfAllocatedHere( address ) == true && "Memory wasn't allocated in this pool !" );
+#endif
+
+	if(IsClassAddress( address ))
+	{
+		m_classPools[GetClassOfAddress( address )]->Deallocate( address );
+	}
+	else
+	{
+		m_dynamicPool->Deallocate( address );
+	}
+}
+/////////////////////////////////////////////////////
+
+// Sized Deallocate, class is taken from address as aligned allocations
+// come from class bigger than their size, size is only used to skip
+// looking up block size in dynamic pool
+void
+SizeClassPool::Deallocate( void* address, size_t size )
+{
+#ifdef _DEBUG
+	assert( CheckIfAllocatedHere( address ) == true && "Memory wasn't allocated in this pool !" );
+#endif
+
+	if(IsClassAddress( address ))
+	{
+		size_t sizeClass = GetClassOfAddress( address );
+#ifdef _DEBUG
+		assert( size <= (MIN_CLASS_SIZE << sizeClass) && "Size does not match allocation" );
+#endif
+		(void)size;
+		m_classPools[sizeClass]->Deallocate( address );
+	}
+	else if(size > MAX_REQUEST_SIZE)
+	{
+		// no allocation can be that big, size is not trusted
+		assert( false && "Size does not match allocation" );
+		m_dynamicPool->Deallocate( address );
+	}
+	else
+	{
+		// dynamic pool was given size rounded up to alignment
+		size = ((size + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+		m_dynamicPool->Deallocate( address, (size == 0) ? ALIGNMENT : size );
+	}
+}
+/////////////////////////////////////////////////////
+
+// Method returns usable size at given address
+size_t
+SizeClassPool::GetAllocationSize( void* address ) const
+{
+	if(IsClassAddress( address ))
+	{
+		return MIN_CLASS_SIZE << GetClassOfAddress( address );
+	}
+	return m_dynamicPool->GetAllocationSize( address );
+}
+/////////////////////////////////////////////////////
+
+// Method checks if address is in one of class regions
+bool
+SizeClassPool::IsClassAddress( void* address ) const
+{
+	char* bytePtr = reinterpret_cast<char*>(address);
+	return bytePtr >= m_classMemory && bytePtr < m_classMemory + (m_classRegionSize * NR_OF_CLASSES);
+}
+/////////////////////////////////////////////////////
+
+// Method returns index of smallest power of two class size can fit in
+size_t
+SizeClassPool::GetSizeClass( size_t size )
+{
+	size_t sizeClass = 0;
+	size_t classSize = MIN_CLASS_SIZE;
+
+	while(classSize < size && sizeClass < NR_OF_CLASSES)
+	{
+		classSize <<= 1;
+		sizeClass++;
+	}
+
+	return sizeClass;
+}
+/////////////////////////////////////////////////////
+
+// Methods sum values of all pools
+size_t
+SizeClassPool::GetNumberOfAllocations( void ) const
+{
+	size_t total = m_dynamicPool->GetNumberOfAllocations();
+	for(size_t i = 0; i < NR_OF_CLASSES; i++)
+	{
+		total += m_classPools[i]->GetNumberOfAllocations();
+	}
+	return total;
+}
+
+size_t
+SizeClassPool::GetTotalAllocated( void ) const
+{
+	size_t total = m_dynamicPool->GetTotalAllocated();
+	for(size_t i = 0; i < NR_OF_CLASSES; i++)
+	{
+		total += m_classPools[i]->GetTotalAllocated();
+	}
+	return total;
+}
+
+size_t
+SizeClassPool::GetNumberOfBlocks() const
+{
+	size_t total = m_dynamicPool->GetNumberOfBlocks();
+	for(size_t i = 0; i < NR_OF_CLASSES; i++)
+	{
+		total += m_classPools[i]->GetNumberOfBlocks();
+	}
+	return total;
+}
+/////////////////////////////////////////////////////
+
+// Methods return overhead and largest free block
+size_t
+SizeClassPool::GetTotalOverhead( void ) const
+{
+	return (size_t)(m_classMemory - reinterpret_cast<char*>(m_poolMemory)) + m_dynamicPool->GetTotalOverhead();
+}
+
+size_t
+SizeClassPool::GetLargestFreeBlock( void ) const
+{
+	return m_dynamicPool->GetLargestFreeBlock();
+}
+/////////////////////////////////////////////////////
+
+// Method passes whole budget to pool being verified,
+// next pool is started once it finishes its pass
+bool
+SizeClassPool::VerifyHeap( size_t maxBlocks )
+{
+	MemoryPool* pool = (m_verifyPool < NR_OF_CLASSES) ? static_cast<MemoryPool*>(m_classPools[m_verifyPool]) : m_dynamicPool;
+
+	if(pool->VerifyHeap( maxBlocks ) == false)
+	{
+		return false;
+	}
+
+	m_verifyPool = (m_verifyPool < NR_OF_CLASSES) ? m_verifyPool + 1 : 0;
+	return m_verifyPool == 0;
+}
+/////////////////////////////////////////////////////
+
+/******************* Internal Methods *********************/
+
+// internal method returns class index of address in class regions
+size_t
+SizeClassPool::GetClassOfAddress( void* address ) const
+{
+	return (size_t)(reinterpret_cast<char*>(address) - m_classMemory) / m_classRegionSize;
+}
+/////////////////////////////////////////////////////
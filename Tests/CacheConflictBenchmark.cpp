@@ -0,0 +1,144 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//	File:		CacheConflictBenchmark.cpp
+//	Author:		Rafal Rebisz
+//	Purpose:	Measures reading first cache line of live blocks of fixed pool
+//				with default layout against pool with colored slabs
+
+//	Use:		Build together with pool sources, e.g.
+//				g++ -std=c++17 -O2 -I.. -o conflictbench CacheConflictBenchmark.cpp
+//					../FixedAllocationSizePool.cpp ../MemoryPool.cpp
+//					../MemoryPoolRegistry.cpp
+//				or with CMake target CacheConflictBenchmark, run with
+//				[block size] [live blocks], without arguments every case is run
+
+//	NOTE:		Blocks of power of two size in default layout start at the same
+//				offset of every page, so their first lines fall into few cache sets,
+//				as when walking object headers. Best of ROUNDS runs is printed.
+//				Returns 1 if blocks of any layout overlap or are not line aligned
+
+#include "../FixedAllocationSizePool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// number of timed runs, fastest is kept
+	const int ROUNDS = 9;
+
+	// number of block reads per run
+	const size_t READS_PER_ROUND = 200000;
+
+	const size_t CACHE_LINE_SIZE = 64;
+
+	// Measures one layout, returns ns per block or negative value if layout is broken
+	double MeasureLayout( char* memory, size_t blockSize, size_t nrOfLiveBlocks, unsigned int layout )
+	{
+		size_t nrOfBlocks = nrOfLiveBlocks * 2;
+		FixedAllocationSizePool pool( memory, nrOfBlocks, blockSize, "CacheConflict", false, layout );
+
+		std::vector<char*> blocks;
+		for(size_t i = 0; i < nrOfLiveBlocks; i++)
+		{
+			char* address = reinterpret_cast<char*>(pool.TryAllocate( blockSize ));
+			if(address == nullptr)
+			{
+				break;
+			}
+			memset( address, 1, blockSize );
+			blocks.push_back( address );
+		}
+
+		// blocks must be inside pool, not overlap and colored blocks start on line
+		std::vector<char*> sorted( blocks );
+		std::sort( sorted.begin(), sorted.end() );
+		for(size_t i = 0; i < sorted.size(); i++)
+		{
+			if(sorted[i] < memory || sorted[i] + blockSize > memory + nrOfBlocks * blockSize ||
+			   (i > 0 && sorted[i - 1] + blockSize > sorted[i]) ||
+			   (layout != FixedAllocationSizePool::DEFAULT_LAYOUT && (reinterpret_cast<uintptr_t>(sorted[i]) % CACHE_LINE_SIZE) != 0))
+			{
+				return -1.0;
+			}
+		}
+
+		size_t repeats = READS_PER_ROUND / blocks.size() + 1;
+		volatile long long sink = 0;
+		double best = 1e30;
+
+		for(int round = 0; round < ROUNDS; round++)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			long long sum = 0;
+			for(size_t r = 0; r < repeats; r++)
+			{
+				for(char* address: blocks)
+				{
+					sum += *reinterpret_cast<long long*>(address);
+					sum += *reinterpret_cast<long long*>(address + 8);
+				}
+			}
+			sink = sum;
+
+			best = std::min( best, std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count() );
+		}
+		(void)sink;
+
+		for(char* address: blocks)
+		{
+			pool.Deallocate( address );
+		}
+
+		return best / (double)(repeats * blocks.size());
+	}
+
+	// Runs both layouts for one case, returns false if any layout is broken
+	bool RunCase( size_t blockSize, size_t nrOfLiveBlocks )
+	{
+		std::vector<char> raw( nrOfLiveBlocks * 2 * blockSize + CACHE_LINE_SIZE );
+		char* memory = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw.data()) + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+
+		double plain = MeasureLayout( memory, blockSize, nrOfLiveBlocks, FixedAllocationSizePool::DEFAULT_LAYOUT );
+		double colored = MeasureLayout( memory, blockSize, nrOfLiveBlocks, FixedAllocationSizePool::COLOR_SLABS );
+
+		printf( "block %5zu live %5zu default %.2f ns/block colored %.2f ns/block\n", blockSize, nrOfLiveBlocks, plain, colored );
+		return plain >= 0.0 && colored >= 0.0;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	bool isValid = true;
+
+	if(argc > 2)
+	{
+		isValid = RunCase( (size_t)atoll( argv[1] ), (size_t)atoll( argv[2] ) );
+	}
+	else
+	{
+		const size_t cases[][2] = { { 4096, 64 }, { 4096, 1024 }, { 8192, 64 }, { 8192, 512 }, { 1024, 2048 } };
+
+		for(const size_t* testCase: cases)
+		{
+			isValid = RunCase( testCase[0], testCase[1] ) && isValid;
+		}
+	}
+
+	if(isValid == false)
+	{
+		printf( "FAILED: blocks overlap or are not line aligned\n" );
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//	File:		CoalescingChurnBenchmark.cpp
+//	Author:		Rafal Rebisz
+//	Purpose:	Measures DynamicAllocationSizePool with eager coalescing
+//				against deferred coalescing on free / reallocate churn
+
+//	Use:		Build together with pool sources, e.g.
+//				g++ -std=c++17 -O2 -I.. -o churnbench CoalescingChurnBenchmark.cpp
+//					../DynamicAllocationSizePool.cpp ../MemoryPool.cpp
+//					../MemoryPoolRegistry.cpp
+//				or with CMake target CoalescingChurnBenchmark, run with [operations]
+
+//	NOTE:		LIVE_BLOCKS blocks of 300-2000 bytes stay allocated, every operation
+//				frees random block and allocates block of the same size again.
+//				Both modes replay the same sequence, returns 1 if any pool does not
+//				end with all memory merged back into its main block
+
+#include "../DynamicAllocationSizePool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// number of blocks kept allocated
+	const size_t LIVE_BLOCKS = 4096;
+
+	// size of pool, far above live memory so main block never runs out
+	const size_t POOL_SIZE = (size_t)256 << 20;
+
+	// Runs churn on pool in given mode, returns ns per free / allocate pair
+	double RunChurn( void* memory, bool deferCoalescing, size_t nrOfOperations, bool& isClean )
+	{
+		DynamicAllocationSizePool pool( memory, POOL_SIZE, deferCoalescing ? "ChurnDeferred" : "ChurnEager", deferCoalescing );
+		size_t freeSize = pool.GetLargestFreeBlock();
+
+		std::mt19937 random( 2 );
+		std::vector<void*> blocks( LIVE_BLOCKS );
+		std::vector<size_t> sizes( LIVE_BLOCKS );
+
+		for(size_t i = 0; i < LIVE_BLOCKS; i++)
+		{
+			sizes[i] = 300 + random() % 1700;
+			blocks[i] = pool.Allocate( sizes[i] );
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		for(size_t i = 0; i < nrOfOperations; i++)
+		{
+			size_t index = random() % LIVE_BLOCKS;
+			pool.Deallocate( blocks[index] );
+			blocks[index] = pool.Allocate( sizes[index] );
+		}
+
+		double time = std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count() / nrOfOperations;
+
+		for(void* address: blocks)
+		{
+			pool.Deallocate( address );
+		}
+		pool.CoalesceQuickLists();
+
+		isClean = pool.GetNumberOfAllocations() == 0 && pool.GetLargestFreeBlock() == freeSize;
+		return time;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	size_t nrOfOperations = (argc > 1) ? (size_t)atoll( argv[1] ) : 20000000;
+
+	std::vector<char> memory( POOL_SIZE );
+
+	bool eagerClean = false;
+	bool deferredClean = false;
+
+	double eager = RunChurn( memory.data(), false, nrOfOperations, eagerClean );
+	double deferred = RunChurn( memory.data(), true, nrOfOperations, deferredClean );
+
+	printf( "eager %.1f ns/op, deferred %.1f ns/op\n", eager, deferred );
+
+	if(eagerClean == false || deferredClean == false)
+	{
+		printf( "FAILED: pool did not merge back into main block\n" );
+		return 1;
+	}
+
+	return 0;
+}
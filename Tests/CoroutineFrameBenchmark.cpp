@@ -0,0 +1,191 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//	File:		CoroutineFrameBenchmark.cpp
+//	Author:		Rafal Rebisz
+//	Purpose:	Measures coroutine frames allocated from global heap against
+//				frames allocated from SizeClassPool through CoroutineFrameAllocator
+//				and checks frames fall back to operator new once pool is exhausted
+
+//	Use:		Build with C++20, e.g.
+//				g++ -std=c++20 -O2 -I.. -o coroutinebench CoroutineFrameBenchmark.cpp
+//					../CoroutineFrameAllocator.cpp ../SizeClassPool.cpp
+//					../FixedAllocationSizePool.cpp ../DynamicAllocationSizePool.cpp
+//					../MemoryPool.cpp ../MemoryPoolRegistry.cpp
+//				or with CMake target CoroutineFrameBenchmark, run with [items]
+
+//	NOTE:		Three stage pipeline creates coroutine per item per stage and keeps
+//				BATCH_SIZE suspended pipelines alive before running them, so frames
+//				of several sizes are live at once. Returns 1 if pooled and heap runs
+//				give different results or fallback check fails
+
+#include "../CoroutineFrameAllocator.h"
+#include "../FixedAllocationSizePool.h"
+#include "../SizeClassPool.h"
+
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace
+{
+	// number of pipelines kept suspended at once
+	const int BATCH_SIZE = 100000;
+
+	// promise base of frames allocated with global operator new
+	struct HeapPromise {};
+
+	// Task returning int, started when run
+	template<class PromiseBase>
+	struct Task
+	{
+		struct promise_type: PromiseBase
+		{
+			int value = 0;
+
+			Task get_return_object() { return Task{ std::coroutine_handle<promise_type>::from_promise( *this ) }; }
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_always final_suspend() noexcept { return {}; }
+			void return_value( int result ) { value = result; }
+			void unhandled_exception() { std::abort(); }
+		};
+
+		std::coroutine_handle<promise_type> handle;
+
+		// Runs task to completion, destroys its frame and returns its value
+		int Run()
+		{
+			handle.resume();
+			int result = handle.promise().value;
+			handle.destroy();
+			return result;
+		}
+	};
+
+	// pipeline stages, locals give frames of different sizes
+	template<class PromiseBase>
+	Task<PromiseBase> Parse( int item )
+	{
+		char text[40];
+		text[0] = (char)item;
+		co_return item * 3 + text[0] % 2;
+	}
+
+	template<class PromiseBase>
+	Task<PromiseBase> Transform( int item )
+	{
+		int parsed = Parse<PromiseBase>( item ).Run();
+		double scratch[24];
+		scratch[0] = parsed;
+		co_return (int)scratch[0] + 1;
+	}
+
+	template<class PromiseBase>
+	Task<PromiseBase> Stage( int item )
+	{
+		int transformed = Transform<PromiseBase>( item ).Run();
+		char buffer[400];
+		buffer[0] = 1;
+		co_return transformed + buffer[0];
+	}
+
+	// Runs items through pipeline in batches, returns ns per item
+	template<class PromiseBase>
+	double RunPipeline( int nrOfItems, long long& sum )
+	{
+		std::vector<Task<PromiseBase>> batch;
+		batch.reserve( BATCH_SIZE );
+
+		auto start = std::chrono::steady_clock::now();
+
+		for(int done = 0; done < nrOfItems; done += BATCH_SIZE)
+		{
+			for(int i = 0; i < BATCH_SIZE; i++)
+			{
+				batch.push_back( Stage<PromiseBase>( i ) );
+			}
+			for(Task<PromiseBase>& task: batch)
+			{
+				sum += task.Run();
+			}
+			batch.clear();
+		}
+
+		return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count() / nrOfItems;
+	}
+
+	// Creates more frames than small fixed pool holds, pool must
+	// serve what it can and the rest must come from operator new
+	bool CheckFallback()
+	{
+		const size_t NR_OF_BLOCKS = 4;
+		std::vector<char> memory( NR_OF_BLOCKS * 1024 );
+		FixedAllocationSizePool pool( memory.data(), NR_OF_BLOCKS, 1024, "CoroutineFallback" );
+		CoroutineFrameAllocator::ScopedPool scope( &pool );
+
+		std::vector<Task<PooledCoroutinePromise>> tasks;
+		for(int i = 0; i < 10; i++)
+		{
+			tasks.push_back( Parse<PooledCoroutinePromise>( i ) );
+		}
+
+		bool poolFull = pool.GetNumberOfAllocations() == NR_OF_BLOCKS;
+
+		for(Task<PooledCoroutinePromise>& task: tasks)
+		{
+			task.Run();
+		}
+
+		return poolFull && pool.GetNumberOfAllocations() == 0;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	int nrOfItems = (argc > 1) ? atoi( argv[1] ) : 2000000;
+	nrOfItems = ((nrOfItems + BATCH_SIZE - 1) / BATCH_SIZE) * BATCH_SIZE;
+
+	// pool memory is reserved, pages are only touched when used
+	size_t poolSize = (size_t)1 << 30;
+	void* memory = mmap( nullptr, poolSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+	if(memory == MAP_FAILED)
+	{
+		printf( "could not reserve %zu bytes\n", poolSize );
+		return 1;
+	}
+
+	long long heapSum = 0;
+	long long pooledSum = 0;
+	long long warmUp = 0;
+	double heapTime = 0.0;
+	double pooledTime = 0.0;
+	size_t framesLeft = 0;
+
+	RunPipeline<HeapPromise>( BATCH_SIZE, warmUp );
+	heapTime = RunPipeline<HeapPromise>( nrOfItems, heapSum );
+
+	// pool keeps its class pools in its memory, it is destroyed before memory is released
+	{
+		SizeClassPool pool( memory, poolSize, (size_t)64 << 20, "CoroutineFrames", true );
+		CoroutineFrameAllocator::ScopedPool scope( &pool );
+
+		RunPipeline<PooledCoroutinePromise>( BATCH_SIZE, warmUp );
+		pooledTime = RunPipeline<PooledCoroutinePromise>( nrOfItems, pooledSum );
+		framesLeft = pool.GetNumberOfAllocations();
+	}
+
+	munmap( memory, poolSize );
+
+	bool fallback = CheckFallback();
+
+	printf( "global heap %.1f ns/item, pooled %.1f ns/item, frames left in pool %zu, fallback %s\n",
+			heapTime, pooledTime, framesLeft, fallback ? "ok" : "FAILED" );
+
+	return (heapSum == pooledSum && framesLeft == 0 && fallback) ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//	File:		HardenedCostBenchmark.cpp
+//	Author:		Rafal Rebisz
+//	Purpose:	Measures allocate / free pair of SizeClassPool, built once
+//				plain and once with POOL_HARDENED to find cost of hardening
+
+//	Use:		Build twice together with pool sources, e.g.
+//				g++ -std=c++17 -O2 [-DPOOL_HARDENED] -I.. -o hardenedbench
+//					HardenedCostBenchmark.cpp ../SizeClassPool.cpp
+//					../FixedAllocationSizePool.cpp ../DynamicAllocationSizePool.cpp
+//					../MemoryPool.cpp ../MemoryPoolRegistry.cpp
+//				or with CMake target HardenedCostBenchmark configured with and
+//				without POOL_HARDENED, run with [live blocks] [max size], without
+//				arguments every case is run
+
+//	NOTE:		Every operation frees random live block, allocates block of random
+//				size up to max size and writes its first byte. Best of ROUNDS runs
+//				is printed, run builds alternately as timing is noisy
+
+#include "../SizeClassPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include <sys/mman.h>
+
+namespace
+{
+	// number of timed runs, fastest is kept
+	const int ROUNDS = 15;
+
+	// number of free / allocate pairs per run
+	const size_t NR_OF_OPERATIONS = 2000000;
+
+	// Returns ns per free / allocate pair, negative value if pool was not left empty
+	double RunCase( void* memory, size_t poolSize, size_t nrOfLiveBlocks, size_t maxSize )
+	{
+		std::mt19937 random( 7 );
+		std::vector<unsigned int> values( NR_OF_OPERATIONS );
+		for(unsigned int& value: values)
+		{
+			value = random();
+		}
+
+		std::vector<void*> blocks( nrOfLiveBlocks );
+		double best = 1e30;
+
+		for(int round = 0; round < ROUNDS; round++)
+		{
+			SizeClassPool pool( memory, poolSize, (size_t)64 << 20, "HardenedCost", true );
+
+			for(size_t i = 0; i < nrOfLiveBlocks; i++)
+			{
+				blocks[i] = pool.Allocate( 1 + values[i] % maxSize );
+			}
+
+			auto start = std::chrono::steady_clock::now();
+
+			for(size_t i = 0; i < NR_OF_OPERATIONS; i++)
+			{
+				size_t index = values[i] % nrOfLiveBlocks;
+				pool.Deallocate( blocks[index] );
+				blocks[index] = pool.Allocate( 1 + (values[i] >> 12) % maxSize );
+				*reinterpret_cast<char*>(blocks[index]) = 1;
+			}
+
+			best = std::min( best, std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count() );
+
+			for(void* address: blocks)
+			{
+				pool.Deallocate( address );
+			}
+
+			if(pool.GetNumberOfAllocations() != 0)
+			{
+				return -1.0;
+			}
+		}
+
+		return best / NR_OF_OPERATIONS;
+	}
+}
+
+int main( int argc, char** argv )
+{
+	// pool memory is reserved, pages are only touched when used
+	size_t poolSize = (size_t)1 << 30;
+	void* memory = mmap( nullptr, poolSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+	if(memory == MAP_FAILED)
+	{
+		printf( "could not reserve %zu bytes\n", poolSize );
+		return 1;
+	}
+
+#ifdef POOL_HARDENED
+	const char* build = "hardened";
+#else
+	const char* build = "plain";
+#endif
+
+	std::vector<std::pair<size_t, size_t>> cases;
+	if(argc > 2)
+	{
+		cases.push_back( std::make_pair( (size_t)atoll( argv[1] ), (size_t)atoll( argv[2] ) ) );
+	}
+	else
+	{
+		cases = { { 100, 16 }, { 20000, 16 }, { 100, 600 }, { 20000, 600 } };
+	}
+
+	bool isValid = true;
+	for(const std::pair<size_t, size_t>& testCase: cases)
+	{
+		double time = RunCase( memory, poolSize, testCase.first, testCase.second );
+		printf( "%-8s live %5zu max size %4zu: %.2f ns/op\n", build, testCase.first, testCase.second, time );
+		isValid = isValid && time >= 0.0;
+	}
+
+	munmap( memory, poolSize );
+
+	if(isValid == false)
+	{
+		printf( "FAILED: pool was not left empty\n" );
+		return 1;
+	}
+
+	return 0;
+}
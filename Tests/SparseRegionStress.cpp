@@ -0,0 +1,250 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//	File:		SparseRegionStress.cpp
+//	Author:		Rafal Rebisz
+//	Purpose:	Runs pools on huge lazily committed region, checks sizes and
+//				counts above 4 GB and 2^32 blocks are kept without wrapping
+
+//	Use:		Build together with pool sources, e.g.
+//				g++ -std=c++17 -O2 -I.. -o sparsestress SparseRegionStress.cpp
+//					../DynamicAllocationSizePool.cpp ../FixedAllocationSizePool.cpp
+//					../SizeClassPool.cpp ../SharedDynamicAllocationSizePool.cpp
+//					../MemoryPool.cpp ../MemoryPoolRegistry.cpp
+//				or with CMake target SparseRegionStress, returns 0 on success,
+//				77 if region can not be reserved and 1 if any check failed
+
+//	NOTE:		Region is reserved with MAP_NORESERVE and pools only touch pages
+//				holding their metadata, test fails if resident size grows by more
+//				than MAX_RESIDENT_GROWTH. Fixed pool test hands out 2^32 + 100
+//				blocks one by one and takes about 20 seconds
+
+#include "../DynamicAllocationSizePool.h"
+#include "../FixedAllocationSizePool.h"
+#include "../SharedDynamicAllocationSizePool.h"
+#include "../SizeClassPool.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+	const size_t GB = (size_t)1 << 30;
+
+	// size of reserved region, far above physical memory
+	const size_t REGION_SIZE = 512 * GB;
+
+	// resident size test may grow by
+	const size_t MAX_RESIDENT_GROWTH = GB;
+
+	// number of failed checks
+	int g_failures = 0;
+
+	// Prints failed check, test continues so every failure is listed
+	void Check( bool condition, const char* what )
+	{
+		if(condition == false)
+		{
+			printf( "FAILED: %s\n", what );
+			g_failures++;
+		}
+	}
+
+	// Returns resident size of process in bytes
+	size_t GetResidentSize()
+	{
+		unsigned long long pages = 0;
+		unsigned long long resident = 0;
+
+		FILE* statm = fopen( "/proc/self/statm", "r" );
+		if(statm != nullptr)
+		{
+			if(fscanf( statm, "%llu %llu", &pages, &resident ) != 2)
+			{
+				resident = 0;
+			}
+			fclose( statm );
+		}
+
+		return (size_t)resident * (size_t)sysconf( _SC_PAGESIZE );
+	}
+
+	// Blocks of 3-7 GB are split from main block and recycled blocks,
+	// counters must follow them and return to zero
+	void TestDynamicPool( void* region )
+	{
+		size_t poolSize = 400 * GB;
+		DynamicAllocationSizePool pool( region, poolSize, "SparseDynamic", false, true );
+
+		size_t freeSize = pool.GetLargestFreeBlock();
+		Check( freeSize > 399 * GB, "dynamic pool main block covers whole pool" );
+
+		std::vector<void*> blocks;
+		size_t requested = 0;
+		for(size_t i = 0; i < 40; i++)
+		{
+			size_t size = (3 + (i % 5)) * GB + i * 4096;
+			char* address = reinterpret_cast<char*>(pool.TryAllocate( size ));
+			Check( address != nullptr, "dynamic pool serves 3-7 GB block" );
+			if(address == nullptr)
+			{
+				return;
+			}
+
+			// first and last page of every block are touched
+			address[0] = 1;
+			address[size - 1] = 1;
+
+			blocks.push_back( address );
+			requested += size;
+		}
+
+		Check( pool.GetNumberOfAllocations() == 40, "dynamic pool counts 40 huge blocks" );
+		Check( pool.GetTotalAllocated() >= requested && pool.GetTotalAllocated() < requested + 40 * 4096, "dynamic pool total allocated is not truncated" );
+
+		// every other block is returned, 2 GB requests split recycled blocks
+		for(size_t i = 0; i < blocks.size(); i += 2)
+		{
+			pool.Deallocate( blocks[i] );
+			blocks[i] = nullptr;
+		}
+
+		for(size_t i = 0; i < 20; i++)
+		{
+			void* address = pool.TryAllocate( 2 * GB );
+			Check( address != nullptr, "dynamic pool splits recycled block for 2 GB request" );
+			blocks.push_back( address );
+		}
+
+		size_t nrOfBlocks = pool.GetNumberOfBlocks();
+
+		for(void* address: blocks)
+		{
+			if(address != nullptr)
+			{
+				pool.Deallocate( address );
+			}
+		}
+
+		Check( nrOfBlocks > 40, "recycled blocks above 2 GB were split" );
+		Check( pool.GetNumberOfAllocations() == 0, "dynamic pool allocation count returns to zero" );
+		Check( pool.GetTotalAllocated() == 0, "dynamic pool total allocated returns to zero" );
+		Check( pool.GetLargestFreeBlock() == freeSize, "dynamic pool merges back into one main block" );
+		Check( pool.VerifyHeap( ~(size_t)0 ), "dynamic pool verification finishes" );
+	}
+
+	// Fixed pool with more than 2^32 blocks, blocks are handed out without
+	// being touched so only returned blocks are committed
+	void TestFixedPool( void* region )
+	{
+		const size_t blockSize = 16;
+		const size_t nrOfBlocks = ((size_t)1 << 32) + 100;
+		FixedAllocationSizePool pool( region, nrOfBlocks, blockSize, "SparseFixed" );
+
+		Check( pool.GetNumberOfBlocks() == nrOfBlocks, "fixed pool reports 2^32 + 100 blocks" );
+
+		void* first = pool.TryAllocate( blockSize );
+		void* last = first;
+		for(size_t i = 1; i < nrOfBlocks; i++)
+		{
+			last = pool.TryAllocate( blockSize );
+		}
+
+		Check( first == region, "fixed pool hands out first block first" );
+		Check( last == reinterpret_cast<char*>(region) + (nrOfBlocks - 1) * blockSize, "fixed pool last block lies past 64 GB" );
+		Check( pool.GetNumberOfAllocations() == nrOfBlocks, "fixed pool counts 2^32 + 100 allocations" );
+		Check( pool.GetTotalAllocated() == nrOfBlocks * blockSize, "fixed pool total allocated is not truncated" );
+		Check( pool.TryAllocate( blockSize ) == nullptr, "fixed pool is exhausted after last block" );
+
+		// block past 2^32 is returned and handed out again
+		pool.Deallocate( last );
+		Check( pool.TryAllocate( blockSize ) == last, "fixed pool reuses block past 2^32" );
+		Check( pool.GetNumberOfAllocations() == nrOfBlocks, "fixed pool count survives reuse" );
+	}
+
+	// Size class pool passes requests above class sizes to its dynamic pool
+	void TestSizeClassPool( void* region )
+	{
+		size_t poolSize = 400 * GB;
+		SizeClassPool pool( region, poolSize, 64 * ((size_t)1 << 20), "SparseSizeClass", true );
+
+		size_t size = 300 * GB;
+		char* address = reinterpret_cast<char*>(pool.TryAllocate( size ));
+		Check( address != nullptr, "size class pool serves 300 GB request" );
+		if(address == nullptr)
+		{
+			return;
+		}
+
+		address[size - 1] = 1;
+		Check( pool.GetAllocationSize( address ) >= size, "size class pool reports full size of 300 GB block" );
+
+		pool.Deallocate( address, size );
+		Check( pool.GetNumberOfAllocations() == 0, "size class pool allocation count returns to zero" );
+		Check( pool.TryAllocate( ~(size_t)0 - 4 ) == nullptr, "size class pool rejects size that wraps when rounded" );
+	}
+
+	// Shared pool keeps offsets as 64 bit values
+	void TestSharedPool( void* region )
+	{
+		size_t poolSize = 64 * GB;
+		SharedDynamicAllocationSizePool pool( region, poolSize, "SparseShared", true );
+		Check( pool.IsValid(), "shared pool is formatted" );
+
+		std::vector<void*> blocks;
+		for(size_t i = 0; i < 10; i++)
+		{
+			void* address = pool.TryAllocate( 5 * GB );
+			Check( address != nullptr, "shared pool serves 5 GB block" );
+			blocks.push_back( address );
+		}
+
+		Check( pool.GetOffset( blocks[9] ) > 45 * GB, "shared pool offset is not truncated" );
+		Check( pool.GetAddress( pool.GetOffset( blocks[9] ) ) == blocks[9], "shared pool offset converts back to address" );
+
+		for(void* address: blocks)
+		{
+			if(address != nullptr)
+			{
+				pool.Deallocate( address );
+			}
+		}
+
+		Check( pool.GetNumberOfAllocations() == 0, "shared pool allocation count returns to zero" );
+		Check( pool.Verify(), "shared pool is consistent" );
+	}
+}
+
+int main()
+{
+	void* region = mmap( nullptr, REGION_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+	if(region == MAP_FAILED)
+	{
+		printf( "SKIPPED: could not reserve %zu GB\n", REGION_SIZE / GB );
+		return 77;
+	}
+
+	size_t residentSize = GetResidentSize();
+
+	// every test gets clean region, pages are released before next one
+	TestDynamicPool( region );
+	madvise( region, REGION_SIZE, MADV_DONTNEED );
+	TestFixedPool( region );
+	madvise( region, REGION_SIZE, MADV_DONTNEED );
+	TestSizeClassPool( region );
+	madvise( region, REGION_SIZE, MADV_DONTNEED );
+	TestSharedPool( region );
+
+	Check( GetResidentSize() < residentSize + MAX_RESIDENT_GROWTH, "pools only commit pages they touch" );
+
+	munmap( region, REGION_SIZE );
+
+	printf( "%s: %d failed checks\n", (g_failures == 0) ? "PASSED" : "FAILED", g_failures );
+	return (g_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+// THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+//	File:		PoolTop.cpp
+//	Author:		Rafal Rebisz
+//	Purpose:	Displays pool counters published by PoolStatsPage of another
+//				process, refreshed periodically like top
+
+//	Use:		Build together with shared memory sources, e.g.
+//				g++ -std=c++17 -O2 -I.. -o pooltop PoolTop.cpp ../PoolStatsPage.cpp
+//					../SharedMemoryRegion.cpp -lrt
+//				and run pooltop <page name> [interval ms] [iterations]
+
+//	NOTE:		Reader attaches to the page read only, it never creates or removes
+//				the page and never waits for the writer, slot that is being written
+//				during every read attempt is skipped for one refresh. Free space is
+//				pool size less allocated and overhead bytes, fragmentation is share
+//				of free space not usable by largest request
+
+#include "../PoolStatsPage.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+	// Prints byte count with binary unit
+	void PrintBytes( uint64_t bytes )
+	{
+		const char* units[] = { "B", "K", "M", "G", "T" };
+		double value = (double)bytes;
+		size_t unit = 0;
+
+		while(value >= 1024.0 && unit < 4)
+		{
+			value /= 1024.0;
+			unit++;
+		}
+
+		if(unit == 0)
+		{
+			printf( " %9llu%s", (unsigned long long)bytes, units[unit] );
+		}
+		else
+		{
+			printf( " %9.1f%s", value, units[unit] );
+		}
+	}
+
+	// Prints one refresh of every used slot
+	void PrintPage( const void* page )
+	{
+		uint64_t now = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch() ).count();
+
+		printf( "publish %llu\n", (unsigned long long)PoolStatsPage::GetPublishCount( page ) );
+		printf( "%-24s %-28s %10s %10s %10s %10s %10s %10s %7s %8s\n",
+				"POOL", "TYPE", "SIZE", "ALLOCATED", "OVERHEAD", "FREE", "LARGEST", "ALLOCS", "FRAG%", "AGE ms" );
+
+		for(size_t i = 0; i < PoolStatsPage::MAX_POOLS; i++)
+		{
+			PoolStatsPage::PoolStats stats;
+			if(PoolStatsPage::ReadPool( page, i, stats ) == false)
+			{
+				continue;
+			}
+
+			uint64_t used = stats.totalAllocated + stats.totalOverhead;
+			uint64_t freeBytes = (stats.poolSize > used) ? stats.poolSize - used : 0;
+			double fragmentation = (freeBytes > 0 && stats.largestFreeBlock > 0) ?
+				100.0 * (1.0 - (double)stats.largestFreeBlock / (double)freeBytes) : 0.0;
+			if(fragmentation < 0.0)
+			{
+				fragmentation = 0.0;
+			}
+
+			uint64_t age = (now > stats.publishTime) ? (now - stats.publishTime) / 1000000 : 0;
+
+			printf( "%-24.24s %-28.28s", stats.poolID, stats.poolType );
+			PrintBytes( stats.poolSize );
+			PrintBytes( stats.totalAllocated );
+			PrintBytes( stats.totalOverhead );
+			PrintBytes( freeBytes );
+			PrintBytes( stats.largestFreeBlock );
+			printf( " %10llu %7.1f %8llu\n", (unsigned long long)stats.nrOfAllocations, fragmentation, (unsigned long long)age );
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	if(argc < 2)
+	{
+		printf( "usage: %s <page name> [interval ms] [iterations]\n", argv[0] );
+		return 1;
+	}
+
+	int interval = (argc > 2) ? atoi( argv[2] ) : 1000;
+	int iterations = (argc > 3) ? atoi( argv[3] ) : 0;
+
+	// reader only attaches, page of process publishing under this name is never created or removed
+	SharedMemoryRegion region( argv[1], PoolStatsPage::PAGE_SIZE, true );
+	if(region.IsValid() == false)
+	{
+		printf( "no stats page named %s\n", argv[1] );
+		return 1;
+	}
+
+	for(int i = 0; iterations == 0 || i < iterations; i++)
+	{
+		if(PoolStatsPage::IsValidPage( region.GetAddress() ) == false)
+		{
+			printf( "stats page %s is not published\n", argv[1] );
+			return 1;
+		}
+
+		// clear terminal when refreshing continuously
+		if(iterations != 1)
+		{
+			printf( "\033[H\033[2J" );
+		}
+
+		PrintPage( region.GetAddress() );
+		fflush( stdout );
+
+		if(iterations == 0 || i + 1 < iterations)
+		{
+			std::this_thread::sleep_for( std::chrono::milliseconds( interval ) );
+		}
+	}
+
+	return 0;
+}